@@ -14,11 +14,20 @@ typedef AsstId AsstMsgId;
 typedef AsstId AsstTaskId;
 typedef AsstId AsstAsyncCallId;
 
+typedef int32_t AsstImageFormat;
+
 typedef int32_t AsstOptionKey;
 typedef AsstOptionKey AsstStaticOptionKey;
 typedef AsstOptionKey AsstInstanceOptionKey;
 
 typedef void(ASST_CALL* AsstApiCallback)(AsstMsgId msg, const char* details_json, void* custom_arg);
+// 批量回调：events 是 count 个首尾相接的 CBOR (RFC 8949) 数据项，共 events_size 字节
+// 每个数据项为数组 [msg, details]，details 与 AsstApiCallback 中的 json 内容相同
+typedef void(ASST_CALL* AsstApiBatchCallback)(
+    const void* events,
+    AsstSize events_size,
+    AsstSize count,
+    void* custom_arg);
 
 #ifdef __cplusplus
 extern "C"
@@ -30,6 +39,8 @@ extern "C"
 
     AsstHandle ASSTAPI AsstCreate();
     AsstHandle ASSTAPI AsstCreateEx(AsstApiCallback callback, void* custom_arg);
+    // 回调以二进制批量形式给出，适合消息频繁的场景
+    AsstHandle ASSTAPI AsstCreateBatch(AsstApiBatchCallback callback, void* custom_arg);
     void ASSTAPI AsstDestroy(AsstHandle handle);
 
     AsstBool ASSTAPI
@@ -65,8 +76,26 @@ extern "C"
     AsstAsyncCallId ASSTAPI AsstAsyncScreencap(AsstHandle handle, AsstBool block);
 
     AsstSize ASSTAPI AsstGetImage(AsstHandle handle, void* buff, AsstSize buff_size);
+    // 按 format 获取上次的截图并直接写入 buff，返回写入的字节数
+    // 帧序号与 last_frame_seq 相同时（画面未更新）不写入，返回 0
+    // buff 为空或不够大时返回 NullSize，width / height / stride / frame_seq 仍会填写，可据此分配缓冲区
+    AsstSize ASSTAPI AsstGetImageEx(
+        AsstHandle handle,
+        AsstImageFormat format,
+        uint64_t last_frame_seq,
+        void* buff,
+        AsstSize buff_size,
+        int32_t* width,
+        int32_t* height,
+        int32_t* stride,
+        uint64_t* frame_seq);
     AsstSize ASSTAPI AsstGetUUID(AsstHandle handle, char* buff, AsstSize buff_size);
     AsstSize ASSTAPI AsstGetTasksList(AsstHandle handle, AsstTaskId* buff, AsstSize buff_size);
+    // 获取自上次重置以来的耗时统计（json），按任务链、识别器、推理、控制器操作等分类，
+    // host 字段为进程级共享线程池（SharedWorkers）的状态
+    // 写入以 '\0' 结尾的字符串，返回不含 '\0' 的字节数，buff 不够大时返回 NullSize
+    AsstSize ASSTAPI AsstGetPerfStats(AsstHandle handle, char* buff, AsstSize buff_size);
+    AsstBool ASSTAPI AsstResetPerfStats(AsstHandle handle);
     AsstSize ASSTAPI AsstGetNullSize();
 
     ASSTAPI_PORT const char* ASST_CALL AsstGetVersion();
@@ -48,6 +48,21 @@ struct CustomImage {
   3: binary data,
 }
 
+// shared memory created by the client, split into slot_count slots of slot_size bytes
+struct SharedMemoryParam {
+  1: string name,
+  2: i32 slot_count,
+  3: i64 slot_size,
+}
+
+// frame written into a shared memory slot, slot < 0 means the frame is not available
+struct SharedImage {
+  1: Size size,
+  2: i32 type,
+  3: i32 slot,
+  4: i64 seq,
+}
+
 service ThriftController {
   bool connect(),
 
@@ -56,6 +71,9 @@ service ThriftController {
   string get_uuid(),
   CustomImage screencap(),
 
+  bool attach_shared_memory(1: SharedMemoryParam param),
+  SharedImage screencap_shared(),
+
   bool start_game(1: string activity),
   bool stop_game(1: string activity),
 
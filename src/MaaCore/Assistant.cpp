@@ -1,7 +1,9 @@
 #include "Assistant.h"
 
+#include "Utils/Cbor.hpp"
 #include "Utils/NoWarningCV.h"
 #include "Utils/Ranges.hpp"
+#include <cstring>
 #include <meojson/json.hpp>
 
 #include "Config/GeneralConfig.h"
@@ -9,6 +11,7 @@
 #include "Config/OnnxSessions.h"
 #include "Config/ResourceLoader.h"
 #include "Controller/Controller.h"
+#include "InstanceHost.h"
 #include "Status.h"
 #include "Task/Interface/AwardTask.h"
 #include "Task/Interface/CloseDownTask.h"
@@ -51,6 +54,14 @@ bool ::AsstExtAPI::set_static_option(StaticOptionKey key, const std::string& val
         OnnxSessions::get_instance().use_gpu(device_id);
         return true;
     } break;
+    case StaticOptionKey::SharedWorkers: {
+        int count = std::stoi(value);
+        if (count < 0) {
+            Log.error(__FUNCTION__, "| invalid worker count:", count);
+            return false;
+        }
+        return InstanceHost::get_instance().set_worker_count(static_cast<size_t>(count));
+    } break;
     default:
         Log.error(__FUNCTION__, "| unknown key:", static_cast<int>(key));
         break;
@@ -66,9 +77,19 @@ Assistant::Assistant(ApiCallback callback, void* callback_arg) : m_callback(call
     m_status = std::make_shared<Status>();
     m_ctrler = std::make_shared<Controller>(append_callback_for_inst, this);
 
-    m_msg_thread = std::thread(&Assistant::msg_proc, this);
-    m_call_thread = std::thread(&Assistant::call_proc, this);
-    m_working_thread = std::thread(&Assistant::working_proc, this);
+    start_workers();
+}
+
+Assistant::Assistant(ApiBatchCallback batch_callback, void* callback_arg) :
+    m_batch_callback(batch_callback),
+    m_callback_arg(callback_arg)
+{
+    LogTraceFunction;
+
+    m_status = std::make_shared<Status>();
+    m_ctrler = std::make_shared<Controller>(append_callback_for_inst, this);
+
+    start_workers();
 }
 
 Assistant::~Assistant()
@@ -104,9 +125,21 @@ Assistant::~Assistant()
     if (m_msg_thread.joinable()) {
         m_msg_thread.join();
     }
-    if (m_callback) {
-        m_callback(static_cast<AsstMsgId>(AsstMsg::Destroyed), "{}", m_callback_arg);
+    // 控制器的输入可能也在线程池里执行，先停下
+    m_ctrler->stop_input();
+    if (m_shared_workers) {
+        // 线程池里可能还有本实例的任务，等它们跑完。异步调用会产生回调，所以先等调用
+        {
+            std::unique_lock<std::mutex> lock(m_call_mutex);
+            m_call_condvar.wait(lock, [&]() { return !m_call_scheduled; });
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_msg_mutex);
+            m_msg_condvar.wait(lock, [&]() { return !m_msg_scheduled; });
+        }
+        InstanceHost::get_instance().detach_instance();
     }
+    dispatch_callbacks({ { AsstMsg::Destroyed, json::object {} } });
 }
 
 bool asst::Assistant::set_instance_option(InstanceOptionKey key, const std::string& value)
@@ -304,6 +337,67 @@ std::vector<uchar> asst::Assistant::get_image() const
     return buf;
 }
 
+std::optional<size_t> asst::Assistant::get_image(ImageFormat format, uint64_t last_frame_seq, void* buff,
+                                                 size_t buff_size, ImageInfo& info) const
+{
+    if (!inited()) {
+        return std::nullopt;
+    }
+
+    // 画面没变就不用缩放、编码了
+    if (m_ctrler->get_image_seq() == last_frame_seq) {
+        info.frame_seq = last_frame_seq;
+        return 0;
+    }
+
+    uint64_t frame_seq = 0;
+    cv::Mat img = m_ctrler->get_image_cache(frame_seq);
+    info.width = img.cols;
+    info.height = img.rows;
+    info.stride = 0;
+    info.frame_seq = frame_seq;
+
+    std::vector<uchar> encoded;
+    switch (format) {
+    case ImageFormat::Png:
+        cv::imencode(".png", img, encoded);
+        break;
+    case ImageFormat::PngFast:
+        cv::imencode(".png", img, encoded, { cv::IMWRITE_PNG_COMPRESSION, 1 });
+        break;
+    case ImageFormat::Jpeg:
+        cv::imencode(".jpg", img, encoded, { cv::IMWRITE_JPEG_QUALITY, 90 });
+        break;
+    case ImageFormat::Bgr:
+    case ImageFormat::Rgba: {
+        const int channels = format == ImageFormat::Bgr ? 3 : 4;
+        info.stride = img.cols * channels;
+        const size_t data_size = static_cast<size_t>(info.stride) * img.rows;
+        if (buff == nullptr || buff_size < data_size) {
+            return std::nullopt;
+        }
+        // 直接以调用方的缓冲区作为输出，不经过中间拷贝
+        cv::Mat dst(img.rows, img.cols, CV_8UC(channels), buff, info.stride);
+        if (format == ImageFormat::Bgr) {
+            img.copyTo(dst);
+        }
+        else {
+            cv::cvtColor(img, dst, cv::COLOR_BGR2RGBA);
+        }
+        return data_size;
+    }
+    default:
+        Log.error(__FUNCTION__, "| unknown image format", static_cast<int>(format));
+        return std::nullopt;
+    }
+
+    if (buff == nullptr || buff_size < encoded.size()) {
+        return std::nullopt;
+    }
+    std::memcpy(buff, encoded.data(), encoded.size());
+    return encoded.size();
+}
+
 bool asst::Assistant::connect(const std::string& adb_path, const std::string& address, const std::string& config)
 {
     LogTraceFunction;
@@ -353,6 +447,27 @@ std::vector<Assistant::TaskId> asst::Assistant::get_tasks_list() const
     return result;
 }
 
+std::string asst::Assistant::get_perf_stats() const
+{
+    json::value result = m_perf_stats.to_json();
+
+    // 共享线程池是进程级的，所有实例看到的都一样
+    const auto host_stats = InstanceHost::get_instance().get_stats();
+    result["host"] = json::object {
+        { "shared", m_shared_workers },
+        { "workers", host_stats.workers },
+        { "instances", host_stats.instances },
+        { "pending_jobs", host_stats.pending_jobs },
+        { "finished_jobs", host_stats.finished_jobs },
+    };
+    return result.to_string();
+}
+
+void asst::Assistant::reset_perf_stats()
+{
+    m_perf_stats.reset();
+}
+
 bool asst::Assistant::start(bool block)
 {
     LogTraceFunction;
@@ -398,6 +513,9 @@ void Assistant::working_proc()
 {
     LogTraceFunction;
 
+    // 任务线程上的识别、推理等都记到本实例名下
+    PerfStats::Binding perf_binding(&m_perf_stats);
+
     std::vector<TaskId> finished_tasks;
     while (true) {
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -426,7 +544,11 @@ void Assistant::working_proc()
         };
         append_callback(AsstMsg::TaskChainStart, callback_json);
 
-        bool ret = task_ptr->run();
+        bool ret = false;
+        {
+            PerfStats::Scope perf_scope(&m_perf_stats, PerfStats::Category::Task, task_ptr->get_task_chain());
+            ret = task_ptr->run();
+        }
         finished_tasks.emplace_back(id);
 
         lock.lock();
@@ -476,14 +598,60 @@ void Assistant::msg_proc()
             continue;
         }
 
-        auto [msg, detail] = std::move(m_msg_queue.front());
-        m_msg_queue.pop();
+        auto msgs = pop_all_msgs();
         lock.unlock();
 
-        if (m_callback) {
+        dispatch_callbacks(msgs);
+    }
+}
+
+void Assistant::msg_job()
+{
+    std::unique_lock<std::mutex> lock(m_msg_mutex);
+    auto msgs = pop_all_msgs();
+    lock.unlock();
+
+    dispatch_callbacks(msgs);
+
+    lock.lock();
+    if (!m_msg_queue.empty()) {
+        lock.unlock();
+        InstanceHost::get_instance().post([this]() { msg_job(); });
+        return;
+    }
+    m_msg_scheduled = false;
+    m_msg_condvar.notify_all();
+}
+
+std::vector<std::pair<AsstMsg, json::value>> Assistant::pop_all_msgs()
+{
+    // 一次取走队列里积压的所有消息，批量回调时合并成一次调用
+    std::vector<std::pair<AsstMsg, json::value>> msgs;
+    msgs.reserve(m_msg_queue.size());
+    while (!m_msg_queue.empty()) {
+        msgs.emplace_back(std::move(m_msg_queue.front()));
+        m_msg_queue.pop();
+    }
+    return msgs;
+}
+
+void Assistant::dispatch_callbacks(const std::vector<std::pair<AsstMsg, json::value>>& msgs) const
+{
+    if (m_callback) {
+        for (const auto& [msg, detail] : msgs) {
             m_callback(static_cast<AsstMsgId>(msg), detail.to_string().c_str(), m_callback_arg);
         }
     }
+
+    if (m_batch_callback && !msgs.empty()) {
+        std::string events;
+        for (const auto& [msg, detail] : msgs) {
+            utils::cbor::append_head(events, 4, 2);
+            utils::cbor::append_integer(events, static_cast<AsstMsgId>(msg));
+            utils::cbor::append(events, detail);
+        }
+        m_batch_callback(events.data(), events.size(), msgs.size(), m_callback_arg);
+    }
 }
 
 asst::Assistant::AsyncCallId asst::Assistant::append_async_call(AsyncCallItem::Type type, AsyncCallItem::Parmas params,
@@ -499,11 +667,22 @@ asst::Assistant::AsyncCallId asst::Assistant::append_async_call(AsyncCallItem::T
 
         m_call_queue.emplace(std::move(item));
         m_call_condvar.notify_one();
+
+        if (m_shared_workers && !m_call_scheduled && !m_thread_exit) {
+            m_call_scheduled = true;
+            InstanceHost::get_instance().post([this]() { call_job(); });
+        }
     }
 
     if (block) {
-        // 需要保证队列中id一定是有序的
-        wait_async_id(id);
+        if (m_shared_workers && InstanceHost::in_worker_thread()) {
+            // 在回调里阻塞调用时，线程池的线程可能都在等，投递的调用永远排不上，只能就地执行
+            run_async_calls_until(id);
+        }
+        else {
+            // 需要保证队列中id一定是有序的
+            wait_async_id(id);
+        }
     }
 
     return id;
@@ -545,54 +724,102 @@ void asst::Assistant::call_proc()
         m_call_queue.pop();
         lock.unlock();
 
-        auto start = std::chrono::steady_clock::now();
-        bool ret = false;
-        std::string what;
-
-        switch (call_item.type) {
-        case AsyncCallItem::Type::Connect: {
-            what = "Connect";
-            const auto& [adb_path, address, config] = std::get<AsyncCallItem::ConnectParams>(call_item.params);
-            ret = ctrl_connect(adb_path, address, config);
-        } break;
-        case AsyncCallItem::Type::Click: {
-            what = "Click";
-            const auto& [x, y] = std::get<AsyncCallItem::ClickParams>(call_item.params);
-            ret = ctrl_click(x, y);
-        } break;
-        case AsyncCallItem::Type::Screencap: {
-            what = "Screencap";
-            std::ignore = std::get<AsyncCallItem::ScreencapParams>(call_item.params);
-            ret = ctrl_screencap();
-        } break;
-        default:
-            what = "Unknown";
-            ret = false;
-            break;
+        exec_async_call(call_item);
+    }
+}
+
+void asst::Assistant::call_job()
+{
+    std::unique_lock<std::mutex> exec_lock(m_call_exec_mutex);
+    std::unique_lock<std::mutex> lock(m_call_mutex);
+    if (!m_call_queue.empty() && !m_thread_exit) {
+        auto call_item = std::move(m_call_queue.front());
+        m_call_queue.pop();
+        lock.unlock();
+
+        exec_async_call(call_item);
+
+        lock.lock();
+        if (!m_call_queue.empty() && !m_thread_exit) {
+            lock.unlock();
+            InstanceHost::get_instance().post([this]() { call_job(); });
+            return;
         }
+    }
+    m_call_scheduled = false;
+    m_call_condvar.notify_all();
+}
 
+void asst::Assistant::run_async_calls_until(AsyncCallId id)
+{
+    while (true) {
+        // 其他线程上的 call_job 也是持有 m_call_exec_mutex 取出并执行的，
+        // 拿到锁时队列为空，说明 id 已经执行完了
+        std::unique_lock<std::mutex> exec_lock(m_call_exec_mutex);
+        std::unique_lock<std::mutex> lock(m_call_mutex);
+        if (m_call_queue.empty() || m_thread_exit) {
+            return;
+        }
+        auto call_item = std::move(m_call_queue.front());
+        m_call_queue.pop();
+        lock.unlock();
+
+        exec_async_call(call_item);
+        if (call_item.id >= id) {
+            return;
+        }
+    }
+}
+
+void asst::Assistant::exec_async_call(const AsyncCallItem& call_item)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool ret = false;
+    std::string what;
+
+    switch (call_item.type) {
+    case AsyncCallItem::Type::Connect: {
+        what = "Connect";
+        const auto& [adb_path, address, config] = std::get<AsyncCallItem::ConnectParams>(call_item.params);
+        ret = ctrl_connect(adb_path, address, config);
+    } break;
+    case AsyncCallItem::Type::Click: {
+        what = "Click";
+        const auto& [x, y] = std::get<AsyncCallItem::ClickParams>(call_item.params);
+        ret = ctrl_click(x, y);
+    } break;
+    case AsyncCallItem::Type::Screencap: {
+        what = "Screencap";
+        std::ignore = std::get<AsyncCallItem::ScreencapParams>(call_item.params);
+        ret = ctrl_screencap();
+    } break;
+    default:
+        what = "Unknown";
+        ret = false;
+        break;
+    }
+
+    {
+        std::unique_lock<std::mutex> completed_call_lock(m_completed_call_mutex);
+        m_completed_call = call_item.id;
+        m_completed_call_condvar.notify_all();
+    }
+
+    auto cost =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    json::value cb_info = json::object {
+        { "uuid", m_uuid },
+        { "what", what },
+        { "async_call_id", call_item.id },
         {
-            std::unique_lock<std::mutex> completed_call_lock(m_completed_call_mutex);
-            m_completed_call = call_item.id;
-            m_completed_call_condvar.notify_all();
-        }
-
-        auto cost =
-            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        json::value cb_info = json::object {
-            { "uuid", m_uuid },
-            { "what", what },
-            { "async_call_id", call_item.id },
-            {
-                "details",
-                json::object {
-                    { "ret", ret },
-                    { "cost", cost },
-                },
+            "details",
+            json::object {
+                { "ret", ret },
+                { "cost", cost },
             },
-        };
-        append_callback(AsstMsg::AsyncCallInfo, cb_info);
-    }
+        },
+    };
+    append_callback(AsstMsg::AsyncCallInfo, cb_info);
 }
 
 void Assistant::append_callback(AsstMsg msg, const json::value& detail)
@@ -616,6 +843,11 @@ void Assistant::append_callback(AsstMsg msg, const json::value& detail)
     std::unique_lock<std::mutex> lock(m_msg_mutex);
     m_msg_queue.emplace(msg, std::move(more_detail));
     m_msg_condvar.notify_one();
+
+    if (m_shared_workers && !m_msg_scheduled && !m_thread_exit) {
+        m_msg_scheduled = true;
+        InstanceHost::get_instance().post([this]() { msg_job(); });
+    }
 }
 
 void asst::Assistant::append_callback_for_inst(AsstMsg msg, const json::value& detail, Assistant* inst)
@@ -626,6 +858,16 @@ void asst::Assistant::append_callback_for_inst(AsstMsg msg, const json::value& d
     inst->append_callback(msg, detail);
 }
 
+void Assistant::start_workers()
+{
+    m_shared_workers = InstanceHost::get_instance().attach_instance();
+    if (!m_shared_workers) {
+        m_msg_thread = std::thread(&Assistant::msg_proc, this);
+        m_call_thread = std::thread(&Assistant::call_proc, this);
+    }
+    m_working_thread = std::thread(&Assistant::working_proc, this);
+}
+
 void Assistant::clear_cache()
 {
     m_status->clear_number();
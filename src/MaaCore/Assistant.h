@@ -5,11 +5,14 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "Common/AsstMsg.h"
 #include "Common/AsstTypes.h"
+#include "PerfStats.h"
 
 struct AsstExtAPI
 {
@@ -52,10 +55,24 @@ public:
 
     // 获取上次的截图
     virtual std::vector<unsigned char> get_image() const = 0;
+    struct ImageInfo
+    {
+        int width = 0;
+        int height = 0;
+        int stride = 0; // 每行字节数，仅原始像素格式有效
+        uint64_t frame_seq = 0;
+    };
+    // 按 format 把上次的截图直接写入 buff，返回写入的字节数；画面未更新时返回 0，buff 不够大时返回 std::nullopt
+    virtual std::optional<size_t> get_image(asst::ImageFormat format, uint64_t last_frame_seq, void* buff,
+                                            size_t buff_size, ImageInfo& info) const = 0;
     // 获取 UUID
     virtual std::string get_uuid() const = 0;
     // 获取任务列表
     virtual std::vector<TaskId> get_tasks_list() const = 0;
+    // 获取耗时统计（json），自上次重置起累计
+    virtual std::string get_perf_stats() const = 0;
+    // 重置耗时统计，可在每个任务链开始前调用
+    virtual void reset_perf_stats() = 0;
 
     virtual bool back_to_home() const = 0;
 };
@@ -70,6 +87,7 @@ namespace asst
     {
     public:
         Assistant(ApiCallback callback = nullptr, void* callback_arg = nullptr);
+        Assistant(ApiBatchCallback batch_callback, void* callback_arg);
         virtual ~Assistant() override;
 
         virtual bool set_instance_option(InstanceOptionKey key, const std::string& value) override;
@@ -91,14 +109,20 @@ namespace asst
         virtual bool running() const override;
 
         virtual std::vector<unsigned char> get_image() const override;
+        virtual std::optional<size_t> get_image(ImageFormat format, uint64_t last_frame_seq, void* buff,
+                                                size_t buff_size, ImageInfo& info) const override;
         virtual std::string get_uuid() const override;
         virtual std::vector<TaskId> get_tasks_list() const override;
+        virtual std::string get_perf_stats() const override;
+        virtual void reset_perf_stats() override;
 
         virtual bool back_to_home() const override;
 
     public:
         std::shared_ptr<Controller> ctrler() const { return m_ctrler; }
         std::shared_ptr<Status> status() const { return m_status; }
+        PerfStats& perf_stats() noexcept { return m_perf_stats; }
+        bool shared_workers() const noexcept { return m_shared_workers; }
         bool need_exit() const { return m_thread_idle && m_running; }
 
     private:
@@ -137,9 +161,18 @@ namespace asst
         bool wait_async_id(AsyncCallId id);
 
     private:
+        void start_workers();
         void call_proc();
         void working_proc();
         void msg_proc();
+        // 共享线程池模式下，每次处理一批再重新排队，保证同一实例的消息和调用按顺序、且不并发执行
+        void msg_job();
+        void call_job();
+        // 在线程池的线程里阻塞调用时，按顺序就地执行队列中的调用，直到 id 完成
+        void run_async_calls_until(AsyncCallId id);
+        void exec_async_call(const AsyncCallItem& call_item);
+        std::vector<std::pair<AsstMsg, json::value>> pop_all_msgs(); // 调用时需持有 m_msg_mutex
+        void dispatch_callbacks(const std::vector<std::pair<AsstMsg, json::value>>& msgs) const;
 
     private:
         void clear_cache();
@@ -151,6 +184,7 @@ namespace asst
 
         std::string m_uuid;
 
+        PerfStats m_perf_stats; // 需先于 m_ctrler 构造、后于其析构，输入线程会往里记录
         std::shared_ptr<Controller> m_ctrler = nullptr;
         std::shared_ptr<Status> m_status = nullptr;
 
@@ -158,6 +192,7 @@ namespace asst
         std::list<std::pair<TaskId, std::shared_ptr<InterfaceTask>>> m_tasks_list;
         inline static TaskId m_task_id = 0; // 进程级唯一
         ApiCallback m_callback = nullptr;
+        ApiBatchCallback m_batch_callback = nullptr;
         void* m_callback_arg = nullptr;
 
         std::atomic_bool m_thread_idle = true;
@@ -173,11 +208,16 @@ namespace asst
         std::queue<AsyncCallItem> m_call_queue;
         std::mutex m_call_mutex;
         std::condition_variable m_call_condvar;
+        std::mutex m_call_exec_mutex; // 共享线程池模式下取出并执行调用时持有，保证同一实例的调用不并发、不乱序
 
         AsyncCallId m_completed_call = 0; // 每个实例有自己独立的执行队列，所以不能静态
         std::mutex m_completed_call_mutex;
         std::condition_variable m_completed_call_condvar;
 
+        bool m_shared_workers = false; // 回调和异步调用交给 InstanceHost 的线程池
+        bool m_msg_scheduled = false;  // 受 m_msg_mutex 保护
+        bool m_call_scheduled = false; // 受 m_call_mutex 保护
+
         std::thread m_msg_thread;
         std::thread m_call_thread;
         std::thread m_working_thread;
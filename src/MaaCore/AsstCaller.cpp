@@ -91,6 +91,14 @@ AsstHandle AsstCreateEx(AsstApiCallback callback, void* custom_arg)
     return new asst::Assistant(static_cast<asst::ApiCallback>(callback), custom_arg);
 }
 
+AsstHandle AsstCreateBatch(AsstApiBatchCallback callback, void* custom_arg)
+{
+    if (!inited()) {
+        return nullptr;
+    }
+    return new asst::Assistant(static_cast<asst::ApiBatchCallback>(callback), custom_arg);
+}
+
 void AsstDestroy(AsstHandle handle)
 {
     if (handle == nullptr) {
@@ -245,6 +253,38 @@ AsstSize AsstGetImage(AsstHandle handle, void* buff, AsstSize buff_size)
     return data_size;
 }
 
+AsstSize AsstGetImageEx(
+    AsstHandle handle,
+    AsstImageFormat format,
+    uint64_t last_frame_seq,
+    void* buff,
+    AsstSize buff_size,
+    int32_t* width,
+    int32_t* height,
+    int32_t* stride,
+    uint64_t* frame_seq)
+{
+    if (!inited() || handle == nullptr) {
+        return NullSize;
+    }
+    AsstExtAPI::ImageInfo info;
+    auto data_size = handle->get_image(static_cast<asst::ImageFormat>(format), last_frame_seq, buff,
+                                       static_cast<size_t>(buff_size), info);
+    if (width) {
+        *width = info.width;
+    }
+    if (height) {
+        *height = info.height;
+    }
+    if (stride) {
+        *stride = info.stride;
+    }
+    if (frame_seq) {
+        *frame_seq = info.frame_seq;
+    }
+    return data_size ? static_cast<AsstSize>(*data_size) : NullSize;
+}
+
 AsstSize AsstGetUUID(AsstHandle handle, char* buff, AsstSize buff_size)
 {
     if (!inited() || handle == nullptr || buff == nullptr) {
@@ -273,6 +313,31 @@ AsstSize AsstGetTasksList(AsstHandle handle, AsstTaskId* buff, AsstSize buff_siz
     return data_size;
 }
 
+AsstSize AsstGetPerfStats(AsstHandle handle, char* buff, AsstSize buff_size)
+{
+    if (!inited() || handle == nullptr || buff == nullptr) {
+        return NullSize;
+    }
+    auto stats = handle->get_perf_stats();
+    size_t data_size = stats.size();
+    if (buff_size <= data_size) {
+        return NullSize;
+    }
+    memcpy(buff, stats.data(), data_size * sizeof(decltype(stats)::value_type));
+    buff[data_size] = '\0';
+    return data_size;
+}
+
+AsstBool AsstResetPerfStats(AsstHandle handle)
+{
+    if (!inited() || handle == nullptr) {
+        return AsstFalse;
+    }
+
+    handle->reset_perf_stats();
+    return AsstTrue;
+}
+
 AsstSize AsstGetNullSize()
 {
     return NullSize;
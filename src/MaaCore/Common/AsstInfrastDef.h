@@ -64,7 +64,7 @@ namespace asst::infrast
 {
     struct Oper
     {
-        std::string face_hash; // 有些干员的技能是完全一样的，做个hash区分一下不同干员
+        PerceptualHash face_hash {}; // 有些干员的技能是完全一样的，做个hash区分一下不同干员
         Smiley smiley;
         double mood_ratio = 0; // 心情进度条的百分比
         Doing doing = Doing::Invalid;
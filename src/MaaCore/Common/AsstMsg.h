@@ -60,6 +60,8 @@ namespace asst
     // 对外的回调接口
     using AsstMsgId = int32_t;
     using ApiCallback = void (*)(AsstMsgId msg, const char* details_json, void* custom_arg);
+    // 批量回调，events 为连续的 CBOR 数据项，每项为 [msg, details]
+    using ApiBatchCallback = void (*)(const void* events, uint64_t events_size, uint64_t count, void* custom_arg);
 
     // 内部使用的回调
     class Assistant;
@@ -3,6 +3,7 @@
 #include <array>
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <ostream>
 #include <string>
@@ -32,6 +33,8 @@ namespace asst
         CpuOCR = 1, // use CPU to OCR, no value. It does not support switching after the resource is loaded.
         GpuOCR = 2, // use GPU to OCR, value is gpu_id int to string. It does not support switching after the resource
                     // is loaded.
+        SharedWorkers = 3, // run callbacks and async calls of all instances on a shared thread pool, value is the
+                           // worker count int to string, "0" to disable. Only applies to instances created after it.
     };
 
     enum class InstanceOptionKey
@@ -44,6 +47,15 @@ namespace asst
         KillAdbOnExit = 5,       // 退出时是否杀掉 Adb 进程， "0" | "1"
     };
 
+    enum class ImageFormat
+    {
+        Png = 0,     // 与 AsstGetImage 相同
+        PngFast = 1, // 低压缩等级的 png，编码快、体积大
+        Jpeg = 2,    // jpeg，质量 90
+        Bgr = 3,     // 原始像素，每像素 3 字节 BGR
+        Rgba = 4,    // 原始像素，每像素 4 字节 RGBA
+    };
+
     enum class TouchMode
     {
         Adb = 0,
@@ -259,6 +271,9 @@ namespace asst
         }
     };
 
+    // 16x16 二值化后的感知哈希，行优先，每个 uint64_t 的最高位是最先的像素
+    using PerceptualHash = std::array<uint64_t, 4>;
+
     enum class AlgorithmType
     {
         Invalid = -1,
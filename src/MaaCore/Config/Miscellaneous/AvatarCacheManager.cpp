@@ -1,5 +1,7 @@
 #include "AvatarCacheManager.h"
 
+#include "Utils/NoWarningCV.h"
+
 #include "../TaskData.h"
 #include "BattleDataConfig.h"
 #include "Utils/ImageIo.hpp"
@@ -39,14 +41,39 @@ bool asst::AvatarCacheManager::load(const std::filesystem::path& path)
     return true;
 }
 
-const asst::AvatarCacheManager::AvatarsMap& asst::AvatarCacheManager::get_avatars(battle::Role role)
+void asst::AvatarCacheManager::remove_avatars(battle::Role role)
 {
-    return m_avatars[role];
+    std::unique_lock<std::mutex> lock(m_avatars_mutex);
+    m_avatars.erase(role);
+    m_indexes.erase(role);
 }
 
-void asst::AvatarCacheManager::remove_avatars(battle::Role role)
+asst::AvatarCacheManager::AvatarIndex asst::AvatarCacheManager::get_index(battle::Role role)
 {
-    m_avatars.erase(role);
+    std::unique_lock<std::mutex> lock(m_avatars_mutex);
+    auto iter = m_indexes.find(role);
+    if (iter == m_indexes.end()) {
+        return {};
+    }
+    return iter->second;
+}
+
+cv::Mat asst::AvatarCacheManager::calc_feature(const cv::Mat& avatar)
+{
+    cv::Mat thumb;
+    cv::resize(avatar, thumb, FeatureSize, 0, 0, cv::INTER_AREA);
+    thumb.convertTo(thumb, CV_32F);
+    cv::subtract(thumb, cv::mean(thumb), thumb);
+
+    cv::Mat feature = thumb.reshape(1, 1);
+    double norm = cv::norm(feature);
+    if (norm > std::numeric_limits<float>::epsilon()) {
+        feature /= norm;
+    }
+    else {
+        feature.setTo(0);
+    }
+    return feature;
 }
 
 void asst::AvatarCacheManager::set_avatar(const std::string& name, battle::Role role, const cv::Mat& avatar,
@@ -55,11 +82,11 @@ void asst::AvatarCacheManager::set_avatar(const std::string& name, battle::Role
     LogTraceFunction;
     Log.info(__FUNCTION__, name, ", overlay:", overlay);
 
-    if (overlay) {
-        m_avatars[role].insert_or_assign(name, avatar);
+    {
+        std::unique_lock<std::mutex> lock(m_avatars_mutex);
+        insert_avatar(role, name, avatar, overlay);
     }
-    else {
-        m_avatars[role].try_emplace(name, avatar);
+    if (!overlay) {
         return;
     }
 
@@ -105,7 +132,35 @@ void asst::AvatarCacheManager::_load(LoadItem waiting_to_load)
                 continue;
             }
 
-            m_avatars[role].insert_or_assign(name, std::move(avatar));
+            std::unique_lock<std::mutex> avatars_lock(m_avatars_mutex);
+            insert_avatar(role, name, avatar, true);
         }
     }
 }
+
+bool asst::AvatarCacheManager::insert_avatar(battle::Role role, const std::string& name, const cv::Mat& avatar,
+                                             bool overlay)
+{
+    auto& avatars = m_avatars[role];
+    auto& index = m_indexes[role];
+
+    if (auto iter = avatars.find(name); iter != avatars.end()) {
+        if (!overlay) {
+            return false;
+        }
+        iter->second = avatar;
+
+        auto pos = static_cast<int>(ranges::find(index.names, name) - index.names.begin());
+        index.avatars[pos] = avatar;
+        // get_index 返回的快照可能还在共享这块内存，不能原地修改
+        index.features = index.features.clone();
+        calc_feature(avatar).copyTo(index.features.row(pos));
+        return true;
+    }
+
+    avatars.emplace(name, avatar);
+    index.names.emplace_back(name);
+    index.avatars.emplace_back(avatar);
+    index.features.push_back(calc_feature(avatar));
+    return true;
+}
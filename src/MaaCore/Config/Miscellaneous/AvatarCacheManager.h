@@ -4,6 +4,7 @@
 #include "Config/AbstractResource.h"
 
 #include <future>
+#include <mutex>
 #include <unordered_map>
 
 #include "Utils/NoWarningCVMat.h"
@@ -19,24 +20,41 @@ namespace asst
         using AvatarsMap = std::unordered_map<std::string, cv::Mat>;
         inline static const std::string CacheExtension = ".png";
 
+        // 同一职业的头像索引，用于快速粗筛候选
+        struct AvatarIndex
+        {
+            std::vector<std::string> names;
+            std::vector<cv::Mat> avatars; // 与 names 一一对应
+            cv::Mat features;             // 每行一个头像的粗筛特征（CV_32F，连续存储），见 calc_feature
+        };
+        inline static const cv::Size FeatureSize { 20, 20 };
+
     public:
         virtual ~AvatarCacheManager() override = default;
 
         virtual bool load(const std::filesystem::path& path) override;
 
-        const AvatarsMap& get_avatars(battle::Role role);
         void remove_avatars(battle::Role role);
         void set_avatar(const std::string& name, battle::Role role, const cv::Mat& avatar, bool overlay = true);
+        // 返回的是快照，不受之后加载/修改的影响
+        AvatarIndex get_index(battle::Role role);
+
+        // 缩小后逐通道去均值并归一化，两个特征的点积即为缩小图上的 TM_CCOEFF_NORMED 得分
+        static cv::Mat calc_feature(const cv::Mat& avatar);
 
     private:
         using LoadItem = std::unordered_map<battle::Role, std::unordered_map<std::string, std::filesystem::path>>;
         void _load(LoadItem waiting_to_load);
+        // 调用前需持有 m_avatars_mutex
+        bool insert_avatar(battle::Role role, const std::string& name, const cv::Mat& avatar, bool overlay);
 
         std::filesystem::path m_save_path;
         std::future<void> m_load_future;
         std::mutex m_load_mutex;
+        std::mutex m_avatars_mutex;
 
         std::unordered_map<battle::Role, std::unordered_map<std::string, cv::Mat>> m_avatars;
+        std::unordered_map<battle::Role, AvatarIndex> m_indexes;
     };
     inline static auto& AvatarCache = AvatarCacheManager::get_instance();
 }
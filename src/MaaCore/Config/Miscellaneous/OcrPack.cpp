@@ -9,6 +9,7 @@ ASST_SUPPRESS_CV_WARNINGS_START
 #include "fastdeploy/vision/ocr/ppocr/recognizer.h"
 ASST_SUPPRESS_CV_WARNINGS_END
 
+#include "PerfStats.h"
 #include "Utils/Demangle.hpp"
 #include "Utils/File.hpp"
 #include "Utils/Logger.hpp"
@@ -68,6 +69,7 @@ bool asst::OcrPack::load(const std::filesystem::path& path)
 
 asst::OcrPack::ResultsVec asst::OcrPack::recognize(const cv::Mat& image, bool without_det)
 {
+    std::unique_lock<std::mutex> lock(m_predict_mutex);
     if (!check_and_load()) {
         Log.error(__FUNCTION__, "check_and_load failed");
         return {};
@@ -93,6 +95,11 @@ asst::OcrPack::ResultsVec asst::OcrPack::recognize(const cv::Mat& image, bool wi
         ocr_result.rec_scores.emplace_back(rec_score);
     }
 
+    if (auto* perf_stats = PerfStats::current()) {
+        perf_stats->record(PerfStats::Category::Inference, without_det ? "ocr_rec" : "ocr_pipeline",
+                           std::chrono::steady_clock::now() - start_time);
+    }
+
 #ifdef ASST_DEBUG
     cv::Mat draw = image.clone();
 #endif
@@ -133,6 +140,47 @@ asst::OcrPack::ResultsVec asst::OcrPack::recognize(const cv::Mat& image, bool wi
     return raw_results;
 }
 
+asst::OcrPack::ResultsVec asst::OcrPack::recognize_batch(const std::vector<cv::Mat>& images)
+{
+    if (images.empty()) {
+        return {};
+    }
+    std::unique_lock<std::mutex> lock(m_predict_mutex);
+    if (!check_and_load()) {
+        Log.error(__FUNCTION__, "check_and_load failed");
+        return {};
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<std::string> rec_texts;
+    std::vector<float> rec_scores;
+    {
+        PerfStats::Scope perf_scope(PerfStats::Category::Inference, "ocr_rec_batch");
+        if (!m_rec->BatchPredict(images, &rec_texts, &rec_scores)) {
+            Log.error(__FUNCTION__, "BatchPredict failed");
+            return {};
+        }
+    }
+
+    ResultsVec raw_results;
+    raw_results.reserve(images.size());
+    for (size_t i = 0; i != images.size(); ++i) {
+        Result result {
+            .rect = Rect(0, 0, images[i].cols, images[i].rows),
+            .score = i < rec_scores.size() ? rec_scores[i] : 0.0,
+            .text = i < rec_texts.size() ? std::move(rec_texts[i]) : std::string(),
+        };
+        raw_results.emplace_back(std::move(result));
+    }
+
+    auto costs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+    std::string class_type = utils::demangle(typeid(*this).name());
+    Log.trace(class_type, raw_results, "by OCR Rec batch of", images.size(), ", cost", costs, "ms");
+    return raw_results;
+}
+
 bool asst::OcrPack::check_and_load()
 {
     if (m_det && m_rec) {
@@ -3,6 +3,7 @@
 #include "Common/AsstTypes.h"
 #include "Config/AbstractResource.h"
 
+#include <mutex>
 #include <optional>
 #include <vector>
 
@@ -43,6 +44,8 @@ namespace asst
         void use_gpu(int gpu_id) { m_gpu_id = gpu_id; }
 
         ResultsVec recognize(const cv::Mat& image, bool without_det = false);
+        // 仅识别（不检测），一次推理处理多张图，返回的结果与 images 一一对应
+        ResultsVec recognize_batch(const std::vector<cv::Mat>& images);
 
     protected:
         OcrPack();
@@ -58,6 +61,9 @@ namespace asst
         std::filesystem::path m_rec_label_path;
 
         std::optional<int> m_gpu_id = std::nullopt;
+
+        // fastdeploy 的模型推理不可重入，多线程识别时需要串行
+        std::mutex m_predict_mutex;
     };
 
     class WordOcr final : public SingletonHolder<WordOcr>, public OcrPack
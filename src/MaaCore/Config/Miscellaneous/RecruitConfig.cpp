@@ -15,6 +15,25 @@ std::string asst::RecruitConfig::get_tag_name(const TagId& id) const noexcept
     return iter->second;
 }
 
+const asst::RecruitConfig::OperMask& asst::RecruitConfig::get_tag_opers(const TagId& id) const noexcept
+{
+    auto iter = m_tag_opers.find(id);
+    if (iter == m_tag_opers.cend()) {
+        static const OperMask empty;
+        return empty;
+    }
+    return iter->second;
+}
+
+const asst::RecruitConfig::OperMask& asst::RecruitConfig::get_level_opers(int level) const noexcept
+{
+    if (level < 0 || level > MaxLevel) {
+        static const OperMask empty;
+        return empty;
+    }
+    return m_level_opers[level];
+}
+
 bool asst::RecruitConfig::parse(const json::value& json)
 {
     LogTraceFunction;
@@ -41,6 +60,23 @@ bool asst::RecruitConfig::parse(const json::value& json)
     // 按干员等级排个序
     ranges::sort(m_all_opers, std::greater {}, std::mem_fn(&Recruitment::level));
 
+    if (m_all_opers.size() > MaxNumOfOpers) {
+        Log.error("too many recruitment operators:", m_all_opers.size(), "max:", MaxNumOfOpers);
+        return false;
+    }
+    // 预先建好 tag -> 干员 的位图索引，组合计算时只需要按位与
+    for (size_t i = 0; i < m_all_opers.size(); ++i) {
+        const Recruitment& oper = m_all_opers[i];
+        for (const std::string& tag : oper.tags) {
+            m_tag_opers[tag].set(i);
+        }
+        if (oper.level < 0 || oper.level > MaxLevel) {
+            Log.error("invalid recruitment operator level:", oper.name, oper.level);
+            return false;
+        }
+        m_level_opers[oper.level].set(i);
+    }
+
     return true;
 }
 
@@ -51,4 +87,6 @@ void asst::RecruitConfig::clear()
     m_all_opers.clear();
     m_all_tags.clear();
     m_all_tags_name.clear();
+    m_tag_opers.clear();
+    ranges::fill(m_level_opers, OperMask());
 }
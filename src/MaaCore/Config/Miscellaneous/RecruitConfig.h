@@ -4,6 +4,8 @@
 
 #include "Utils/Ranges.hpp"
 #include <algorithm>
+#include <array>
+#include <bitset>
 #include <numeric>
 #include <string>
 #include <unordered_set>
@@ -57,6 +59,11 @@ namespace asst
     public:
         using TagId = std::string;
 
+        // 干员集合，第 i 位对应 get_all_opers()[i]
+        static constexpr size_t MaxNumOfOpers = 512;
+        using OperMask = std::bitset<MaxNumOfOpers>;
+        static constexpr int MaxLevel = 6;
+
     public:
         static constexpr bool is_valid_extra_tags_mode(ExtraTagsMode mode)
         {
@@ -71,6 +78,11 @@ namespace asst
         const std::vector<Recruitment>& get_all_opers() const noexcept { return m_all_opers; }
         std::string get_tag_name(const TagId& id) const noexcept;
 
+        // 拥有该 tag 的所有干员，未知 tag 返回空集
+        const OperMask& get_tag_opers(const TagId& id) const noexcept;
+        // 该星级的所有干员
+        const OperMask& get_level_opers(int level) const noexcept;
+
     protected:
         virtual bool parse(const json::value& json) override;
 
@@ -79,6 +91,8 @@ namespace asst
         std::unordered_set<std::string> m_all_tags;
         std::vector<Recruitment> m_all_opers;
         std::unordered_map<TagId, std::string> m_all_tags_name;
+        std::unordered_map<TagId, OperMask> m_tag_opers;
+        std::array<OperMask, MaxLevel + 1> m_level_opers;
     };
 
     // 公开招募的干员组合
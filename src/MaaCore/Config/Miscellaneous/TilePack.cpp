@@ -20,11 +20,18 @@ ASST_SUPPRESS_CV_WARNINGS_START
 ASST_SUPPRESS_CV_WARNINGS_END
 
 #include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
 
 bool asst::TilePack::parse(const json::value& json)
 {
     LogTraceFunction;
 
+    // 重新加载（如切换客户端、资源更新）后同一 levelId 的地块可能变了，缓存的计算结果不能再用
+    {
+        std::unique_lock lock(m_calc_cache_mutex);
+        m_calc_cache.clear();
+    }
+
     auto dir = m_path.parent_path();
     for (const auto& [_, summary] : json.as_object()) {
         LevelKey level_key {
@@ -38,13 +45,101 @@ bool asst::TilePack::parse(const json::value& json)
         //     Log.error("file not exists", filepath);
         //     return false;
         // }
+        const size_t index = m_summarize.size();
+        for (int field = 0; field < FieldCount; ++field) {
+            const std::string& value = get_field(level_key, static_cast<LevelKeyField>(field));
+            FieldIndex& field_index = m_field_indexes[field];
+            if (value.empty()) {
+                field_index.empty_positions.emplace_back(index);
+            }
+            else {
+                field_index.positions[value].emplace_back(index);
+            }
+        }
         m_summarize.emplace_back(std::move(level_key), std::move(filepath));
     }
     return true;
 }
 
+const std::string& asst::TilePack::get_field(const LevelKey& key, LevelKeyField field)
+{
+    switch (field) {
+    case StageId:
+        return key.stageId;
+    case Code:
+        return key.code;
+    case LevelId:
+        return key.levelId;
+    default:
+        return key.name;
+    }
+}
+
+std::optional<size_t> asst::TilePack::find_index(const std::string& any_key) const
+{
+    if (any_key.empty()) {
+        return std::nullopt;
+    }
+
+    // 任一字段相等或为空即匹配，取所有候选中最靠前的一个
+    std::optional<size_t> result;
+    auto update = [&](size_t index) {
+        if (!result || index < *result) {
+            result = index;
+        }
+    };
+    for (const FieldIndex& field_index : m_field_indexes) {
+        if (auto iter = field_index.positions.find(any_key); iter != field_index.positions.end()) {
+            update(iter->second.front());
+        }
+        if (!field_index.empty_positions.empty()) {
+            update(field_index.empty_positions.front());
+        }
+    }
+    return result;
+}
+
+std::optional<size_t> asst::TilePack::find_index(const LevelKey& key) const
+{
+    // 按区分度从高到低选一个非空字段缩小范围，再逐个比较完整的 key
+    static constexpr std::array<LevelKeyField, FieldCount> FieldPriority = { LevelId, StageId, Name, Code };
+
+    for (const LevelKeyField field : FieldPriority) {
+        const std::string& value = get_field(key, field);
+        if (value.empty()) {
+            continue;
+        }
+
+        const FieldIndex& field_index = m_field_indexes[field];
+        static const std::vector<size_t> EmptyPositions;
+        auto iter = field_index.positions.find(value);
+        const std::vector<size_t>& positions = iter == field_index.positions.end() ? EmptyPositions : iter->second;
+        const std::vector<size_t>& empty_positions = field_index.empty_positions;
+
+        // 两个下标序列都是升序的，归并着比较即可保证返回最靠前的匹配
+        auto pos_iter = positions.begin();
+        auto empty_iter = empty_positions.begin();
+        while (pos_iter != positions.end() || empty_iter != empty_positions.end()) {
+            size_t index = 0;
+            if (empty_iter == empty_positions.end() || (pos_iter != positions.end() && *pos_iter < *empty_iter)) {
+                index = *pos_iter++;
+            }
+            else {
+                index = *empty_iter++;
+            }
+            if (m_summarize[index].first == key) {
+                return index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // 所有字段都为空，与任何关卡都匹配
+    return m_summarize.empty() ? std::nullopt : std::optional<size_t>(0);
+}
+
 bool proc_data(
-    std::unordered_map<asst::Point, asst::TilePack::TileInfo>& dst,
+    asst::TilePack::TileGrid& dst,
     asst::Point loc,
     cv::Point cv_p,
     const Map::Tile& tile)
@@ -73,13 +168,11 @@ bool proc_data(
         Log.warn("Unknown tile type:", tile.tileKey);
     }
 
-    dst.emplace(
-        loc,
-        TileInfo { static_cast<battle::LocationType>(tile.buildableType),
-                   static_cast<TilePack::HeightType>(tile.heightType),
-                   key,
-                   Point(cv_p.x, cv_p.y),
-                   loc });
+    dst.at(loc) = TileInfo { static_cast<battle::LocationType>(tile.buildableType),
+                             static_cast<TilePack::HeightType>(tile.heightType),
+                             key,
+                             Point(cv_p.x, cv_p.y),
+                             loc };
     return true;
 }
 
@@ -88,12 +181,27 @@ asst::TilePack::result_type
 {
     LogTraceFunction;
 
-    std::vector<std::vector<cv::Point2d>> pos;
-    std::vector<std::vector<Map::Tile>> tiles;
+    TilePack& pack = TilePack::get_instance();
+    std::string cache_key;
+    if (!level.key.levelId.empty()) {
+        cache_key = level.key.levelId + "|" + std::to_string(shift_x) + "|" + std::to_string(shift_y);
+
+        std::unique_lock lock(pack.m_calc_cache_mutex);
+        auto& cache = pack.m_calc_cache;
+        auto iter = ranges::find_if(cache, [&](const auto& cached) { return cached.first == cache_key; });
+        if (iter != cache.end()) {
+            Log.info("tiles calc cache hit:", cache_key);
+            cache.splice(cache.begin(), cache, iter);
+            return cache.front().second;
+        }
+    }
 
-    result_type result;
     const int w = level.get_width();
     const int h = level.get_height();
+    result_type result {
+        .normal_tile_info = TileGrid(w, h),
+        .side_tile_info = TileGrid(w, h),
+    };
     for (int y = 0; y < h; ++y) {
         for (int x = 0; x < w; ++x) {
             const auto tile = level.get_item(y, x);
@@ -117,5 +225,14 @@ asst::TilePack::result_type
     result.retreat_button = { retreat.x, retreat.y };
     result.skill_button = { skill.x, skill.y };
 
+    if (!cache_key.empty()) {
+        std::unique_lock lock(pack.m_calc_cache_mutex);
+        auto& cache = pack.m_calc_cache;
+        cache.emplace_front(std::move(cache_key), result);
+        while (cache.size() > CalcCacheSize) {
+            cache.pop_back();
+        }
+    }
+
     return result;
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <list>
+#include <mutex>
+
 #include "Common/AsstBattleDef.h"
 #include "Common/AsstTypes.h"
 #include "Config/AbstractConfig.h"
@@ -55,10 +59,83 @@ public:
         Point loc; // 格子位置
     };
 
+    // 整张地图的地块信息，按行优先连续存储，下标为 y * width + x
+    class TileGrid
+    {
+    public:
+        using value_type = std::pair<Point, TileInfo>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+    public:
+        TileGrid() = default;
+        TileGrid(int width, int height) :
+            m_width(width),
+            m_height(height)
+        {
+            m_tiles.resize(static_cast<size_t>(width) * height);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    m_tiles[static_cast<size_t>(y) * width + x].first = Point(x, y);
+                }
+            }
+        }
+
+        iterator begin() noexcept { return m_tiles.begin(); }
+        iterator end() noexcept { return m_tiles.end(); }
+        const_iterator begin() const noexcept { return m_tiles.begin(); }
+        const_iterator end() const noexcept { return m_tiles.end(); }
+        const_iterator cbegin() const noexcept { return m_tiles.cbegin(); }
+        const_iterator cend() const noexcept { return m_tiles.cend(); }
+
+        iterator find(const Point& loc) noexcept
+        {
+            return contains(loc) ? m_tiles.begin() + index_of(loc) : m_tiles.end();
+        }
+        const_iterator find(const Point& loc) const noexcept
+        {
+            return contains(loc) ? m_tiles.cbegin() + index_of(loc) : m_tiles.cend();
+        }
+        bool contains(const Point& loc) const noexcept
+        {
+            return loc.x >= 0 && loc.x < m_width && loc.y >= 0 && loc.y < m_height;
+        }
+        TileInfo& at(const Point& loc) { return m_tiles.at(checked_index_of(loc)).second; }
+        const TileInfo& at(const Point& loc) const { return m_tiles.at(checked_index_of(loc)).second; }
+
+        size_t size() const noexcept { return m_tiles.size(); }
+        bool empty() const noexcept { return m_tiles.empty(); }
+        void clear() noexcept
+        {
+            m_tiles.clear();
+            m_width = 0;
+            m_height = 0;
+        }
+        int width() const noexcept { return m_width; }
+        int height() const noexcept { return m_height; }
+
+    private:
+        std::ptrdiff_t index_of(const Point& loc) const noexcept
+        {
+            return static_cast<std::ptrdiff_t>(loc.y) * m_width + loc.x;
+        }
+        size_t checked_index_of(const Point& loc) const
+        {
+            if (!contains(loc)) {
+                throw std::out_of_range("tile location out of range");
+            }
+            return static_cast<size_t>(index_of(loc));
+        }
+
+        int m_width = 0;
+        int m_height = 0;
+        std::vector<value_type> m_tiles;
+    };
+
     struct result_type
     {
-        std::unordered_map<Point, TileInfo> normal_tile_info;
-        std::unordered_map<Point, TileInfo> side_tile_info;
+        TileGrid normal_tile_info;
+        TileGrid side_tile_info;
         Point retreat_button;
         Point skill_button;
     };
@@ -69,12 +146,17 @@ public:
     template <typename KeyT>
     std::optional<LazyMap::value_type> find(const KeyT& key) const
     {
-        for (const auto& pair : m_summarize) {
-            if (pair.first == key) {
-                return pair;
-            }
+        std::optional<size_t> index;
+        if constexpr (std::is_convertible_v<const KeyT&, std::string>) {
+            index = find_index(std::string(key));
+        }
+        else {
+            index = find_index(LevelKey(key));
         }
-        return std::nullopt;
+        if (!index) {
+            return std::nullopt;
+        }
+        return m_summarize.at(*index);
     }
 
     template <typename KeyT>
@@ -111,8 +193,34 @@ protected:
     bool parse(const json::value& json) override;
 
 private:
+    // LevelKey 的比较中空字段可以匹配任何值，索引需保证与顺序查找 m_summarize 的结果一致
+    enum LevelKeyField
+    {
+        StageId,
+        Code,
+        LevelId,
+        Name,
+        FieldCount,
+    };
+    struct FieldIndex
+    {
+        std::unordered_map<std::string, std::vector<size_t>> positions; // 字段值 -> m_summarize 中的下标（升序）
+        std::vector<size_t> empty_positions;                            // 该字段为空的下标（升序）
+    };
+
+    static const std::string& get_field(const LevelKey& key, LevelKeyField field);
+    std::optional<size_t> find_index(const std::string& any_key) const;
+    std::optional<size_t> find_index(const LevelKey& key) const;
+
     result_type static calc_(const Map::Level& data, double shift_x, double shift_y);
+
     LazyMap m_summarize;
+    std::array<FieldIndex, FieldCount> m_field_indexes;
+
+    // 最近计算过的地块信息，同一关卡反复进入时（如肉鸽、刷图）直接复用
+    static constexpr size_t CalcCacheSize = 8;
+    mutable std::mutex m_calc_cache_mutex;
+    mutable std::list<std::pair<std::string, result_type>> m_calc_cache;
 };
 
 inline static auto& Tile = TilePack::get_instance();
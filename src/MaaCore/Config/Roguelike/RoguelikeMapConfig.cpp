@@ -1,5 +1,7 @@
 #include "RoguelikeMapConfig.h"
 
+#include <cmath>
+
 #include <meojson/json.hpp>
 
 #include "Utils/Logger.hpp"
@@ -32,16 +34,116 @@ bool asst::RoguelikeMapConfig::parse(const json::value& json)
     m_templ_type_mappings.erase(theme);
 
     for (const auto& node_json : json.at("node").as_array()) {
-        const RoguelikeNodeType node_type = NodeTypeMapping.at(node_json.at("type").as_string());
+        const std::string type_name = node_json.at("type").as_string();
+        auto type_iter = NodeTypeMapping.find(type_name);
+        if (type_iter == NodeTypeMapping.end()) {
+            Log.error(__FUNCTION__, "| unknown node type", type_name, "in theme", theme);
+            continue;
+        }
+        const RoguelikeNodeType node_type = type_iter->second;
         for (const auto& template_json : node_json.at("template").as_array()) {
             const std::string node_template = template_json.as_string();
             m_templ_type_mappings[theme].emplace(node_template, node_type);
         }
     }
+
+    m_cost_models.erase(theme);
+    auto cost_opt = json.find<json::object>("cost");
+    if (!cost_opt) {
+        return true;
+    }
+
+    // cost 配置有误时只记录日志，该主题继续使用默认的代价模型，不影响资源加载
+    bool cost_valid = true;
+    auto parse_type_costs = [&](const json::value& objective_json, const std::string& key) {
+        std::unordered_map<RoguelikeNodeType, int> type_costs;
+        auto costs_opt = objective_json.find<json::object>(key);
+        if (!costs_opt) {
+            return type_costs;
+        }
+        for (const auto& [type_name, cost] : *costs_opt) {
+            auto type_iter = NodeTypeMapping.find(type_name);
+            if (type_iter == NodeTypeMapping.end() || !cost.is_number()) {
+                Log.error(__FUNCTION__, "| invalid cost of", type_name, "in", key, ", theme", theme);
+                cost_valid = false;
+                continue;
+            }
+            type_costs.emplace(type_iter->second, cost.as_integer());
+        }
+        return type_costs;
+    };
+
+    auto objectives_opt = cost_opt->find<json::array>("objectives");
+    if (!objectives_opt) {
+        Log.error(__FUNCTION__, "| cost.objectives not found, use default cost model, theme", theme);
+        return true;
+    }
+
+    RoguelikeRouteCostModel cost_model;
+    cost_model.max_cost = cost_opt->get("max_cost", cost_model.max_cost);
+    cost_model.visited_cost = cost_opt->get("visited_cost", cost_model.visited_cost);
+    cost_model.full_path = cost_opt->get("full_path", cost_model.full_path);
+    for (const auto& objective_json : *objectives_opt) {
+        if (!objective_json.is_object()) {
+            Log.error(__FUNCTION__, "| cost objective is not an object, theme", theme);
+            cost_valid = false;
+            continue;
+        }
+        RoguelikeRouteObjective objective;
+        objective.name = objective_json.get("name", std::string());
+        objective.weight = objective_json.get("weight", objective.weight);
+        objective.type_costs = parse_type_costs(objective_json, "type_costs");
+        objective.refreshed_type_costs = parse_type_costs(objective_json, "refreshed_type_costs");
+        cost_model.objectives.emplace_back(std::move(objective));
+    }
+    if (!cost_valid) {
+        Log.error(__FUNCTION__, "| invalid cost config, use default cost model, theme", theme);
+        return true;
+    }
+    m_cost_models.emplace(theme, std::move(cost_model));
+
     return true;
 }
 
+asst::RoguelikeRouteCostModel asst::RoguelikeMapConfig::default_cost_model()
+{
+    // 未配置时的代价与早期写死的规则一致：战斗节点代价为 1，刷新过的战斗节点代价为 1000（不可通过）
+    RoguelikeRouteObjective combat { .name = "combat" };
+    for (const RoguelikeNodeType type :
+         { RoguelikeNodeType::CombatOps, RoguelikeNodeType::EmergencyOps, RoguelikeNodeType::DreadfulFoe }) {
+        combat.type_costs.emplace(type, 1);
+        combat.refreshed_type_costs.emplace(type, 1000);
+    }
+
+    RoguelikeRouteCostModel cost_model;
+    cost_model.objectives.emplace_back(std::move(combat));
+    return cost_model;
+}
+
+int asst::RoguelikeRouteCostModel::evaluate(const RoguelikeNode& node) const
+{
+    if (node.visited) {
+        return visited_cost;
+    }
+
+    double cost = 0;
+    for (const RoguelikeRouteObjective& objective : objectives) {
+        if (node.refresh_times) {
+            if (auto iter = objective.refreshed_type_costs.find(node.type);
+                iter != objective.refreshed_type_costs.end()) {
+                cost += objective.weight * iter->second;
+                continue;
+            }
+        }
+        if (auto iter = objective.type_costs.find(node.type); iter != objective.type_costs.end()) {
+            cost += objective.weight * iter->second;
+        }
+    }
+    return static_cast<int>(std::lround(cost));
+}
+
 void asst::RoguelikeMapConfig::clear()
 {
     m_templ_type_mappings.clear();
+    m_cost_models.clear();
 }
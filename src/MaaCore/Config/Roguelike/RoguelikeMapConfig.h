@@ -5,6 +5,25 @@
 
 namespace asst
 {
+// 路线规划的一个目标，节点代价为各目标 weight * type_cost 之和
+struct RoguelikeRouteObjective
+{
+    std::string name;
+    double weight = 1.0;
+    std::unordered_map<RoguelikeNodeType, int> type_costs;
+    std::unordered_map<RoguelikeNodeType, int> refreshed_type_costs; // 节点被刷新过时优先使用
+};
+
+struct RoguelikeRouteCostModel
+{
+    int max_cost = 1000;     // 自身代价不低于该值的节点不可通过，下一步无路可走时放弃本次探索
+    int visited_cost = 1000; // 已经走过的节点
+    bool full_path = true;   // 节点 cost 是否按整条路线计算，否则只向后看一步，见 RoguelikeMap::set_full_path_cost
+    std::vector<RoguelikeRouteObjective> objectives;
+
+    int evaluate(const RoguelikeNode& node) const;
+};
+
 class RoguelikeMapConfig final : public SingletonHolder<RoguelikeMapConfig>, public AbstractConfig
 {
 public:
@@ -16,12 +35,21 @@ public:
         return templ_type_mapping.at(templ_name);
     }
 
+    const RoguelikeRouteCostModel& get_cost_model(const std::string& theme) const noexcept
+    {
+        static const RoguelikeRouteCostModel DefaultCostModel = default_cost_model();
+        auto iter = m_cost_models.find(theme);
+        return iter == m_cost_models.end() ? DefaultCostModel : iter->second;
+    }
+
 private:
     virtual bool parse(const json::value& json) override;
 
     void clear();
+    static RoguelikeRouteCostModel default_cost_model();
 
     std::unordered_map<std::string, std::unordered_map<std::string, RoguelikeNodeType>> m_templ_type_mappings;
+    std::unordered_map<std::string, RoguelikeRouteCostModel> m_cost_models;
 };
 
 inline static auto& RoguelikeMapInfo = RoguelikeMapConfig::get_instance();
@@ -42,6 +42,8 @@ asst::TaskDerivedConstPtr asst::TaskData::get_raw(std::string_view name)
 
 asst::TaskPtr asst::TaskData::get(std::string_view name)
 {
+    std::unique_lock<std::recursive_mutex> lock(m_tasks_mutex);
+
     // 生成过的任务
     if (auto it = m_all_tasks_info.find(name); it != m_all_tasks_info.cend()) {
         return it->second;
@@ -67,6 +69,7 @@ asst::TaskPtr asst::TaskData::get(std::string_view name)
 bool asst::TaskData::lazy_parse(const json::value& json)
 {
     LogTraceFunction;
+    std::unique_lock<std::recursive_mutex> lock(m_tasks_mutex);
 
     if (!json.is_object()) {
         Log.error("parameter json is not a json::object");
@@ -201,6 +204,7 @@ bool asst::TaskData::lazy_parse(const json::value& json)
 bool asst::TaskData::parse(const json::value& json)
 {
     LogTraceFunction;
+    std::unique_lock<std::recursive_mutex> lock(m_tasks_mutex);
 
     if (!lazy_parse(json)) return false;
 
@@ -214,6 +218,7 @@ bool asst::TaskData::parse(const json::value& json)
 
 void asst::TaskData::clear_tasks()
 {
+    std::unique_lock<std::recursive_mutex> lock(m_tasks_mutex);
     // 注意：这会导致已经通过 get 获取的任务指针内容不会更新
     // 即运行期修改对已经获取的任务指针无效，但是不会导致崩溃；要想更新，需要重新获取任务指针
     m_all_tasks_info.clear();
@@ -225,6 +230,7 @@ void asst::TaskData::clear_tasks()
 
 void asst::TaskData::set_task_base(const std::string_view task_name, std::string base_task_name)
 {
+    std::unique_lock<std::recursive_mutex> lock(m_tasks_mutex);
     m_json_all_tasks_info[task_name_view(task_name)]["baseTask"] = std::move(base_task_name);
     clear_tasks();
 }
@@ -2,6 +2,7 @@
 
 #include "AbstractConfigWithTempl.h"
 
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -116,6 +117,8 @@ namespace asst
         std::unordered_map<std::string_view, json::object> m_json_all_tasks_info;  // 原始的 json 信息
         std::unordered_map<std::string_view, TaskDerivedPtr> m_raw_all_tasks_info; // 未展开虚任务的任务信息
         std::unordered_map<std::string_view, TaskPtr> m_all_tasks_info;            // 已展开虚任务的任务信息
+        // get 会懒生成任务并写入上面几个 map，识别可能在多个线程上同时进行；生成时会递归调用 get
+        std::recursive_mutex m_tasks_mutex;
     };
 
     inline static auto& Task = TaskData::get_instance();
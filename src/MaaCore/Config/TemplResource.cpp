@@ -18,6 +18,7 @@ bool asst::TemplResource::load(const std::filesystem::path& path)
     LogTraceFunction;
     Log.info("load", path.lexically_relative(UserDir.get()));
 
+    std::unique_lock<std::mutex> lock(m_templs_mutex);
 #ifdef ASST_DEBUG
     bool some_file_not_exists = false;
 #endif
@@ -54,8 +55,9 @@ bool asst::TemplResource::load(const std::filesystem::path& path)
     return true;
 }
 
-const cv::Mat& asst::TemplResource::get_templ(const std::string& name)
+cv::Mat asst::TemplResource::get_templ(const std::string& name)
 {
+    std::unique_lock<std::mutex> lock(m_templs_mutex);
     if (m_templs.find(name) == m_templs.cend()) {
         // Log.info(__FUNCTION__, "lazy load", name);
 
@@ -66,8 +68,7 @@ const cv::Mat& asst::TemplResource::get_templ(const std::string& name)
 #ifdef ASST_DEBUG
             throw std::runtime_error("templ not found: " + name);
 #else
-            static cv::Mat empty;
-            return empty;
+            return {};
 #endif
         }
 
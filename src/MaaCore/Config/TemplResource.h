@@ -2,6 +2,7 @@
 
 #include "AbstractResource.h"
 
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -18,10 +19,12 @@ namespace asst
         void set_load_required(std::unordered_set<std::string> required) noexcept;
         virtual bool load(const std::filesystem::path& path) override;
 
-        const cv::Mat& get_templ(const std::string& name);
+        // 返回共享数据的 cv::Mat 而不是引用，重新加载资源时其他线程手里的模板不会失效
+        cv::Mat get_templ(const std::string& name);
 
     private:
         std::unordered_set<std::string> m_load_required;
+        std::mutex m_templs_mutex; // get_templ 是懒加载的，可能被多个线程同时调用
         std::unordered_map<std::string, cv::Mat> m_templs;
         std::unordered_map<std::string, std::filesystem::path> m_templ_paths;
     };
@@ -3,6 +3,7 @@
 #include "Assistant.h"
 #include "Common/AsstConf.h"
 #include "Utils/NoWarningCV.h"
+#include <algorithm>
 #include <cstdint>
 #include <numeric>
 
@@ -251,6 +252,11 @@ void asst::AdbController::clear_info() noexcept
     m_width = 0;
     m_height = 0;
     m_screen_size = { 0, 0 };
+    m_screencap_times = 0;
+    m_screencap_samples.clear();
+    m_screencap_candidates.clear();
+    m_screencap_explore_index = 0;
+    m_screencap_times_since_explore = 0;
 }
 
 bool asst::AdbController::inited() const noexcept
@@ -411,8 +417,106 @@ bool asst::AdbController::convert_lf(std::string& data)
 }
 
 bool asst::AdbController::screencap(cv::Mat& image_payload, bool allow_reconnect)
+{
+    if (m_adb.screencap_method == AdbProperty::ScreencapMethod::UnknownYet) {
+        return probe_screencap_method(image_payload, allow_reconnect);
+    }
+
+    // 每隔一段时间换一种候选方式截一次图，网络、CPU 负载等条件变化后，原先最快的方式不一定还是最快
+    std::optional<AdbProperty::ScreencapMethod> explore_method;
+    if (++m_screencap_times_since_explore >= ScreencapExploreInterval) {
+        m_screencap_times_since_explore = 0;
+        explore_method = next_explore_method();
+    }
+    if (explore_method) {
+        // 行尾检测结果是按当前方式得到的，试完再还原
+        const auto end_of_line = m_adb.screencap_end_of_line;
+        clear_lf_info();
+        // 只是试探，失败了直接换回当前方式，不触发重连，也不按常规超时等待
+        bool explore_ret =
+            screencap_by(*explore_method, image_payload, false, screencap_probe_timeout(*explore_method));
+        m_adb.screencap_end_of_line = end_of_line;
+        if (explore_ret) {
+            reevaluate_screencap_method();
+            return true;
+        }
+        Log.info(screencap_method_name(*explore_method), "is not available any more");
+        std::erase(m_screencap_candidates, *explore_method);
+    }
+
+    bool screencap_ret = screencap_by(m_adb.screencap_method, image_payload, allow_reconnect);
+    if (++m_screencap_times > 9) { // 每 10 次截图回传一次耗时统计
+        m_screencap_times = 0;
+        report_screencap_cost();
+    }
+    return screencap_ret;
+}
+
+bool asst::AdbController::probe_screencap_method(cv::Mat& image_payload, bool allow_reconnect)
+{
+    Log.info("Try to find the fastest way to screencap");
+
+    m_screencap_samples.clear();
+    m_screencap_candidates.clear();
+    m_screencap_explore_index = 0;
+    m_screencap_times_since_explore = 0;
+
+    std::vector<AdbProperty::ScreencapMethod> methods = {
+        AdbProperty::ScreencapMethod::RawByNc,
+        AdbProperty::ScreencapMethod::RawWithGzip,
+        AdbProperty::ScreencapMethod::Encode,
+    };
+#if ASST_WITH_EMULATOR_EXTRAS
+    if (m_mumu_extras.inited()) {
+        methods.emplace_back(AdbProperty::ScreencapMethod::MumuExtras);
+    }
+    if (m_ld_extras.inited()) {
+        methods.emplace_back(AdbProperty::ScreencapMethod::LDExtras);
+    }
+#endif
+
+    long long min_cost = LLONG_MAX;
+    for (auto method : methods) {
+        clear_lf_info();
+        if (!screencap_by(method, image_payload, allow_reconnect, screencap_probe_timeout(method))) {
+            Log.info(screencap_method_name(method), "is not supported");
+            continue;
+        }
+        long long cost = m_screencap_samples[method].back().cost;
+        Log.info(screencap_method_name(method), "cost", cost, "ms");
+        m_screencap_candidates.emplace_back(method);
+        if (cost < min_cost) {
+            m_adb.screencap_method = method;
+            m_inited = true;
+            min_cost = cost;
+        }
+    }
+
+    Log.info("The fastest way is", screencap_method_name(m_adb.screencap_method), ", cost:", min_cost, "ms");
+    if (m_adb.screencap_method != AdbProperty::ScreencapMethod::UnknownYet) {
+        json::value info = json::object {
+            { "uuid", m_uuid },
+            { "what", "FastestWayToScreencap" },
+            { "details",
+              json::object {
+                  { "method", screencap_method_name(m_adb.screencap_method) },
+                  { "cost", min_cost },
+              } },
+        };
+        callback(AsstMsg::ConnectionInfo, info);
+    }
+    clear_lf_info();
+    return m_adb.screencap_method != AdbProperty::ScreencapMethod::UnknownYet;
+}
+
+bool asst::AdbController::screencap_by(
+    AdbProperty::ScreencapMethod method,
+    cv::Mat& image_payload,
+    bool allow_reconnect,
+    int timeout)
 {
     using namespace std::chrono;
+
     DecodeFunc decode_raw = [&](const std::string& data) -> bool {
         if (data.size() < 8) {
             return false;
@@ -470,207 +574,214 @@ bool asst::AdbController::screencap(cv::Mat& image_payload, bool allow_reconnect
         return true;
     };
 
-    if (m_adb.screencap_method == AdbProperty::ScreencapMethod::UnknownYet) {
-        Log.info("Try to find the fastest way to screencap");
-        auto min_cost = milliseconds(LLONG_MAX);
-        clear_lf_info();
+    // 统计解码用时，行尾转换后的重试也算在内
+    auto timed = [&](const DecodeFunc& decode_func) -> DecodeFunc {
+        return [&, decode_func](const std::string& data) -> bool {
+            auto decode_start_time = steady_clock::now();
+            bool ret = decode_func(data);
+            m_last_decode_cost += duration_cast<milliseconds>(steady_clock::now() - decode_start_time).count();
+            return ret;
+        };
+    };
 
-        auto start_time = steady_clock::now();
-        if (m_support_socket && m_server_started
-            && screencap(m_adb.screencap_raw_by_nc, decode_raw, allow_reconnect, true, 5000)) {
-            auto duration = duration_cast<milliseconds>(steady_clock::now() - start_time);
-            if (duration < min_cost) {
-                m_adb.screencap_method = AdbProperty::ScreencapMethod::RawByNc;
-                m_inited = true;
-                min_cost = duration;
-            }
-            Log.info("RawByNc cost", duration.count(), "ms");
-        }
-        else {
-            Log.info("RawByNc is not supported");
+    m_last_screencap_bytes = 0;
+    m_last_decode_cost = 0;
+
+    auto start_time = steady_clock::now();
+    bool screencap_ret = false;
+    switch (method) {
+    case AdbProperty::ScreencapMethod::RawByNc:
+        screencap_ret = screencap(m_adb.screencap_raw_by_nc, timed(decode_raw), allow_reconnect, true, timeout);
+        break;
+    case AdbProperty::ScreencapMethod::RawWithGzip:
+        screencap_ret =
+            screencap(m_adb.screencap_raw_with_gzip, timed(decode_raw_with_gzip), allow_reconnect, false, timeout);
+        break;
+    case AdbProperty::ScreencapMethod::Encode:
+        screencap_ret = screencap(m_adb.screencap_encode, timed(decode_encode), allow_reconnect, false, timeout);
+        break;
+#if ASST_WITH_EMULATOR_EXTRAS
+    case AdbProperty::ScreencapMethod::MumuExtras: {
+        auto img_opt = m_mumu_extras.screencap();
+        screencap_ret = img_opt.has_value();
+
+        if (!screencap_ret && allow_reconnect) {
+            m_mumu_extras.reload();
+            img_opt = m_mumu_extras.screencap();
+            screencap_ret = img_opt.has_value();
         }
-        clear_lf_info();
 
-        start_time = steady_clock::now();
-        if (screencap(m_adb.screencap_raw_with_gzip, decode_raw_with_gzip, allow_reconnect)) {
-            auto duration = duration_cast<milliseconds>(steady_clock::now() - start_time);
-            if (duration < min_cost) {
-                m_adb.screencap_method = AdbProperty::ScreencapMethod::RawWithGzip;
-                m_inited = true;
-                min_cost = duration;
-            }
-            Log.info("RawWithGzip cost", duration.count(), "ms");
+        if (screencap_ret) {
+            image_payload = img_opt.value();
         }
-        else {
-            Log.info("RawWithGzip is not supported");
+    } break;
+    case AdbProperty::ScreencapMethod::LDExtras: {
+        auto img_opt = m_ld_extras.screencap();
+        screencap_ret = img_opt.has_value();
+
+        if (!screencap_ret && allow_reconnect) {
+            m_ld_extras.reload();
+            img_opt = m_ld_extras.screencap();
+            screencap_ret = img_opt.has_value();
         }
-        clear_lf_info();
 
-        start_time = steady_clock::now();
-        if (screencap(m_adb.screencap_encode, decode_encode, allow_reconnect)) {
-            auto duration = duration_cast<milliseconds>(steady_clock::now() - start_time);
-            if (duration < min_cost) {
-                m_adb.screencap_method = AdbProperty::ScreencapMethod::Encode;
-                m_inited = true;
-                min_cost = duration;
-            }
-            Log.info("Encode cost", duration.count(), "ms");
-        }
-        else {
-            Log.info("Encode is not supported");
+        if (screencap_ret) {
+            image_payload = img_opt.value();
         }
+    } break;
+#endif
+    default:
+        break;
+    }
+    auto duration = duration_cast<milliseconds>(steady_clock::now() - start_time);
+
+    auto& samples = m_screencap_samples[method];
+    samples.emplace_back(ScreencapSample {
+        .cost = screencap_ret ? duration.count() : -1,
+        .decode_cost = m_last_decode_cost,
+        .bytes = m_last_screencap_bytes,
+    });
+    if (samples.size() > ScreencapSampleSize) {
+        samples.pop_front();
+    }
+    return screencap_ret;
+}
 
-#if ASST_WITH_EMULATOR_EXTRAS
-        if (m_mumu_extras.inited()) {
-            start_time = steady_clock::now();
-            if (m_mumu_extras.screencap()) {
-                auto duration =
-                    duration_cast<milliseconds>(steady_clock::now() - start_time);
-                if (duration < min_cost) {
-                    m_adb.screencap_method = AdbProperty::ScreencapMethod::MumuExtras;
-                    m_inited = true;
-                    min_cost = duration;
-                }
-                Log.info("MumuExtras cost", duration.count(), "ms");
-            }
-            else {
-                Log.info("MumuExtras is not supported");
-            }
+std::optional<asst::AdbController::AdbProperty::ScreencapMethod> asst::AdbController::next_explore_method()
+{
+    for (size_t i = 0; i < m_screencap_candidates.size(); ++i) {
+        auto method = m_screencap_candidates[m_screencap_explore_index++ % m_screencap_candidates.size()];
+        if (method != m_adb.screencap_method) {
+            return method;
         }
-        if (m_ld_extras.inited()) {
-            start_time = steady_clock::now();
-            if (m_ld_extras.screencap()) {
-                auto duration = duration_cast<milliseconds>(steady_clock::now() - start_time);
-                if (duration < min_cost) {
-                    m_adb.screencap_method = AdbProperty::ScreencapMethod::LDExtras;
-                    m_inited = true;
-                    min_cost = duration;
-                }
-                Log.info("LDExtras cost", duration.count(), "ms");
-            }
-            else {
-                Log.info("LDExtras is not supported");
-            }
-        
+    }
+    return std::nullopt;
+}
+
+// 取成功样本耗时的分位数，样本不足时返回 nullopt
+static std::optional<long long> screencap_cost_percentile(const auto& samples, size_t min_samples, double p)
+{
+    std::vector<long long> costs;
+    costs.reserve(samples.size());
+    for (const auto& sample : samples) {
+        if (sample.cost >= 0) {
+            costs.emplace_back(sample.cost);
         }
-#endif
+    }
+    if (costs.empty() || costs.size() < min_samples) {
+        return std::nullopt;
+    }
+    auto nth = costs.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(costs.size() - 1));
+    std::nth_element(costs.begin(), nth, costs.end());
+    return *nth;
+}
 
-        static const std::unordered_map<AdbProperty::ScreencapMethod, std::string> MethodName = {
-            { AdbProperty::ScreencapMethod::UnknownYet, "UnknownYet" },
-            { AdbProperty::ScreencapMethod::RawByNc, "RawByNc" },
-            { AdbProperty::ScreencapMethod::RawWithGzip, "RawWithGzip" },
-            { AdbProperty::ScreencapMethod::Encode, "Encode" },
-#if ASST_WITH_EMULATOR_EXTRAS
-            { AdbProperty::ScreencapMethod::MumuExtras, "MumuExtras" },
-            { AdbProperty::ScreencapMethod::LDExtras, "LDExtras" },
-#endif
-        };
-        Log.info(
-            "The fastest way is",
-            MethodName.at(m_adb.screencap_method),
-            ", cost:",
-            min_cost.count(),
-            "ms");
-        if (m_adb.screencap_method != AdbProperty::ScreencapMethod::UnknownYet) {
-            json::value info = json::object {
-                { "uuid", m_uuid },
-                { "what", "FastestWayToScreencap" },
-                { "details",
-                  json::object {
-                      { "method", MethodName.at(m_adb.screencap_method) },
-                      { "cost", min_cost.count() },
-                  } },
-            };
-            callback(AsstMsg::ConnectionInfo, info);
+void asst::AdbController::reevaluate_screencap_method()
+{
+    const auto current_method = m_adb.screencap_method;
+    auto current_cost = screencap_cost_percentile(m_screencap_samples[current_method], ScreencapMinSamples, 0.5);
+    if (!current_cost) {
+        return;
+    }
+
+    auto best_method = current_method;
+    long long best_cost = *current_cost;
+    for (auto method : m_screencap_candidates) {
+        if (method == current_method) {
+            continue;
+        }
+        auto cost = screencap_cost_percentile(m_screencap_samples[method], ScreencapMinSamples, 0.5);
+        // 至少快 20% 才换，免得在差不多快的方式之间来回切
+        if (cost && *cost * 5 < *current_cost * 4 && *cost < best_cost) {
+            best_method = method;
+            best_cost = *cost;
         }
-        clear_lf_info();
-        return m_adb.screencap_method != AdbProperty::ScreencapMethod::UnknownYet;
     }
-    else {
-        auto start_time = high_resolution_clock::now();
-        bool screencap_ret = false;
-        switch (m_adb.screencap_method) {
-        case AdbProperty::ScreencapMethod::RawByNc:
-            screencap_ret = screencap(m_adb.screencap_raw_by_nc, decode_raw, allow_reconnect, true);
-            break;
-        case AdbProperty::ScreencapMethod::RawWithGzip:
-            screencap_ret =
-                screencap(m_adb.screencap_raw_with_gzip, decode_raw_with_gzip, allow_reconnect);
-            break;
-        case AdbProperty::ScreencapMethod::Encode:
-            screencap_ret = screencap(m_adb.screencap_encode, decode_encode, allow_reconnect);
-            break;
-#if ASST_WITH_EMULATOR_EXTRAS
-        case AdbProperty::ScreencapMethod::MumuExtras: {
-            auto img_opt = m_mumu_extras.screencap();
-            screencap_ret = img_opt.has_value();
+    if (best_method == current_method) {
+        return;
+    }
 
-            if (!screencap_ret && allow_reconnect) {
-                m_mumu_extras.reload();
-                img_opt = m_mumu_extras.screencap();
-                screencap_ret = img_opt.has_value();
-            }
+    Log.info(
+        "Screencap method changed from",
+        screencap_method_name(current_method),
+        "to",
+        screencap_method_name(best_method),
+        ", median cost:",
+        *current_cost,
+        "->",
+        best_cost,
+        "ms");
+    m_adb.screencap_method = best_method;
+    clear_lf_info();
 
-            if (screencap_ret) {
-                image_payload = img_opt.value();
-            }
-        } break;
-        case AdbProperty::ScreencapMethod::LDExtras: {
-            auto img_opt = m_ld_extras.screencap();
-            screencap_ret = img_opt.has_value();
+    json::value info = json::object {
+        { "uuid", m_uuid },
+        { "what", "FastestWayToScreencap" },
+        { "details",
+          json::object {
+              { "method", screencap_method_name(best_method) },
+              { "cost", best_cost },
+          } },
+    };
+    callback(AsstMsg::ConnectionInfo, info);
+}
 
-            if (!screencap_ret && allow_reconnect) {
-                m_ld_extras.reload();
-                img_opt = m_ld_extras.screencap();
-                screencap_ret = img_opt.has_value();
-            }
+void asst::AdbController::report_screencap_cost()
+{
+    const auto& samples = m_screencap_samples[m_adb.screencap_method];
+    auto succeeded = samples | views::filter([](const ScreencapSample& sample) { return sample.cost >= 0; });
+    if (succeeded.empty()) {
+        return;
+    }
 
-            if (screencap_ret) {
-                image_payload = img_opt.value();
-            }
-        } break;
-#endif
-        default:
-            break;
-        }
-        auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - start_time);
-        // 记录截图耗时，每10次截图回传一次最值+平均值
-        m_screencap_cost.emplace_back(screencap_ret ? duration.count() : -1); // 记录截图耗时
-        ++m_screencap_times;
+    long long count = 0;
+    long long cost_sum = 0;
+    long long decode_cost_sum = 0;
+    size_t bytes_sum = 0;
+    long long cost_min = LLONG_MAX;
+    long long cost_max = 0;
+    for (const auto& sample : succeeded) {
+        ++count;
+        cost_sum += sample.cost;
+        decode_cost_sum += sample.decode_cost;
+        bytes_sum += sample.bytes;
+        cost_min = std::min(cost_min, sample.cost);
+        cost_max = std::max(cost_max, sample.cost);
+    }
 
-        if (m_screencap_cost.size() > 30) {
-            m_screencap_cost.pop_front();
-        }
-        if (m_screencap_times > 9) { // 每 10 次截图计算一次平均耗时
-            m_screencap_times = 0;
-            auto filtered_cost = m_screencap_cost | views::filter([](auto num) { return num > 0; });
-            if (filtered_cost.empty()) {
-                return screencap_ret;
-            }
-            // 过滤后的有效截图用时次数
-            auto filtered_count = m_screencap_cost.size() - ranges::count(m_screencap_cost, -1);
-            auto [screencap_cost_min, screencap_cost_max] = ranges::minmax(filtered_cost);
-            json::value info = json::object {
-                { "uuid", m_uuid },
-                { "what", "ScreencapCost" },
-                { "details",
-                  json::object {
-                      { "min", screencap_cost_min },
-                      { "max", screencap_cost_max },
-                      { "avg",
-                        filtered_count > 0
-                            ? std::accumulate(filtered_cost.begin(), filtered_cost.end(), 0ll)
-                                  / filtered_count
-                            : -1 },
-                  } },
-            };
-            if (m_screencap_cost.size() - filtered_count > 0) {
-                info["details"]["fault_times"] = m_screencap_cost.size() - filtered_count;
-            }
-            callback(AsstMsg::ConnectionInfo, info);
-        }
-        return screencap_ret;
+    json::value info = json::object {
+        { "uuid", m_uuid },
+        { "what", "ScreencapCost" },
+        { "details",
+          json::object {
+              { "min", cost_min },
+              { "max", cost_max },
+              { "avg", cost_sum / count },
+              { "p90", screencap_cost_percentile(samples, 1, 0.9).value_or(-1) },
+              { "decode_avg", decode_cost_sum / count },
+              { "bytes_avg", bytes_sum / static_cast<size_t>(count) },
+              { "method", screencap_method_name(m_adb.screencap_method) },
+          } },
+    };
+    if (auto fault_times = static_cast<long long>(samples.size()) - count; fault_times > 0) {
+        info["details"]["fault_times"] = fault_times;
     }
+    callback(AsstMsg::ConnectionInfo, info);
+}
+
+const std::string& asst::AdbController::screencap_method_name(AdbProperty::ScreencapMethod method)
+{
+    static const std::unordered_map<AdbProperty::ScreencapMethod, std::string> MethodName = {
+        { AdbProperty::ScreencapMethod::UnknownYet, "UnknownYet" },
+        { AdbProperty::ScreencapMethod::RawByNc, "RawByNc" },
+        { AdbProperty::ScreencapMethod::RawWithGzip, "RawWithGzip" },
+        { AdbProperty::ScreencapMethod::Encode, "Encode" },
+#if ASST_WITH_EMULATOR_EXTRAS
+        { AdbProperty::ScreencapMethod::MumuExtras, "MumuExtras" },
+        { AdbProperty::ScreencapMethod::LDExtras, "LDExtras" },
+#endif
+    };
+    return MethodName.at(method);
 }
 
 bool asst::AdbController::screencap(
@@ -690,6 +801,7 @@ bool asst::AdbController::screencap(
         return false;
     }
     auto& data = ret.value();
+    m_last_screencap_bytes = data.size();
 
     bool tried_conversion = false;
     if (m_adb.screencap_end_of_line == AdbProperty::ScreencapEndOfLine::CRLF) {
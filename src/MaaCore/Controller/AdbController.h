@@ -5,7 +5,10 @@
 #include "ControllerAPI.h"
 
 #include <deque>
+#include <map>
+#include <optional>
 #include <random>
+#include <vector>
 
 #include "Platform/PlatformFactory.h"
 
@@ -165,6 +168,36 @@ protected:
         } screencap_method = ScreencapMethod::UnknownYet;
     } m_adb;
 
+    struct ScreencapSample
+    {
+        long long cost = -1;       // 总耗时，失败为 -1
+        long long decode_cost = 0; // 其中解码的耗时
+        size_t bytes = 0;          // 传输的数据量
+    };
+
+    // 每种方式保留的样本数
+    static constexpr size_t ScreencapSampleSize = 30;
+    // 每截这么多次图，换一种候选方式截一次，看看它是不是变快了
+    static constexpr int ScreencapExploreInterval = 100;
+    // 样本数不足时不参与比较
+    static constexpr size_t ScreencapMinSamples = 3;
+
+    bool probe_screencap_method(cv::Mat& image_payload, bool allow_reconnect);
+    bool screencap_by(
+        AdbProperty::ScreencapMethod method,
+        cv::Mat& image_payload,
+        bool allow_reconnect,
+        int timeout = 20000);
+    // 试探某种方式时的超时，nc 不通时要等到超时，给短一些
+    static int screencap_probe_timeout(AdbProperty::ScreencapMethod method)
+    {
+        return method == AdbProperty::ScreencapMethod::RawByNc ? 5000 : 20000;
+    }
+    std::optional<AdbProperty::ScreencapMethod> next_explore_method();
+    void reevaluate_screencap_method();
+    void report_screencap_cost();
+    static const std::string& screencap_method_name(AdbProperty::ScreencapMethod method);
+
     std::string m_uuid;
     size_t m_pipe_data_size = 0;
     size_t m_version = 0;
@@ -176,8 +209,13 @@ protected:
     bool m_inited = false;
     bool m_kill_adb_on_exit = false;
     long long m_last_command_duration = 0;  // 上次命令执行用时
-    std::deque<long long> m_screencap_cost; // 截图用时
     int m_screencap_times = 0;              // 截图次数
+    size_t m_last_screencap_bytes = 0;      // 上次截图传输的数据量
+    long long m_last_decode_cost = 0;       // 上次截图解码用时
+    std::map<AdbProperty::ScreencapMethod, std::deque<ScreencapSample>> m_screencap_samples;
+    std::vector<AdbProperty::ScreencapMethod> m_screencap_candidates; // 探测时可用的截图方式
+    size_t m_screencap_explore_index = 0;
+    int m_screencap_times_since_explore = 0;
 
 #if ASST_WITH_EMULATOR_EXTRAS
     MumuExtras m_mumu_extras;
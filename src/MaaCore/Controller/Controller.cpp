@@ -2,12 +2,15 @@
 
 #include "Utils/Platform.hpp"
 
+#include <limits>
 #include <regex>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "Assistant.h"
 #include "Common/AsstConf.h"
+#include "InstanceHost.h"
 #include "Utils/NoWarningCV.h"
 
 #ifdef _MSC_VER
@@ -39,6 +42,8 @@ asst::Controller::Controller(const AsstCallback& callback, Assistant* inst)
 asst::Controller::~Controller()
 {
     LogTraceFunction;
+
+    stop_input();
 }
 
 std::shared_ptr<asst::ControllerAPI> asst::Controller::create_controller(
@@ -131,15 +136,167 @@ void asst::Controller::sync_params()
 
 bool asst::Controller::back_to_home()
 {
+    wait_input_idle();
     m_controller->back_to_home();
     return true;
 }
 
+asst::Controller::InputToken
+    asst::Controller::post_input(std::string_view op, std::function<bool()> func, bool run_async)
+{
+    std::unique_lock<std::mutex> lock(m_input_mutex);
+    m_input_queue.emplace(InputItem { .op = op, .func = std::move(func) });
+    if (run_async) {
+        start_input_runner();
+    }
+    m_input_condvar.notify_one();
+    return ++m_input_submitted;
+}
+
+void asst::Controller::start_input_runner()
+{
+    if (m_input_exit) {
+        return;
+    }
+    if (m_inst && m_inst->shared_workers()) {
+        if (!m_input_scheduled) {
+            m_input_scheduled = true;
+            InstanceHost::get_instance().post([this]() { input_job(); });
+        }
+        return;
+    }
+    if (!m_input_thread.joinable()) {
+        m_input_thread = std::thread(&Controller::input_proc, this);
+    }
+}
+
+bool asst::Controller::run_next_input(InputToken until)
+{
+    // 拿到 m_input_exec_mutex 时，已经取出的输入都执行完了
+    std::unique_lock<std::mutex> exec_lock(m_input_exec_mutex);
+    std::unique_lock<std::mutex> lock(m_input_mutex);
+    if (m_input_exit || m_input_queue.empty() || m_input_completed >= until) {
+        return false;
+    }
+
+    auto item = std::move(m_input_queue.front());
+    m_input_queue.pop();
+    lock.unlock();
+
+    // 空任务是提交时就已失败的输入，只占一个序号以保持顺序
+    bool ret = false;
+    if (item.func) {
+        PerfStats::Scope perf_scope(perf_stats(), PerfStats::Category::Controller, item.op);
+        ret = item.func();
+    }
+
+    lock.lock();
+    ++m_input_completed;
+    m_input_records.emplace_back(InputRecord { .ret = ret });
+    if (m_input_records.size() > InputRecordSize) {
+        m_input_records.pop_front();
+    }
+    m_input_done_condvar.notify_all();
+    return true;
+}
+
+void asst::Controller::input_proc()
+{
+    LogTraceFunction;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_input_mutex);
+            m_input_condvar.wait(lock, [&]() { return m_input_exit || !m_input_queue.empty(); });
+            if (m_input_exit) {
+                return;
+            }
+        }
+        run_next_input(std::numeric_limits<InputToken>::max());
+    }
+}
+
+void asst::Controller::input_job()
+{
+    // 一次把当前排着的输入都执行完，期间新提交的由下一个任务处理
+    InputToken until = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_input_mutex);
+        until = m_input_submitted;
+    }
+    while (run_next_input(until)) {
+    }
+
+    std::unique_lock<std::mutex> lock(m_input_mutex);
+    if (!m_input_queue.empty() && !m_input_exit) {
+        InstanceHost::get_instance().post([this]() { input_job(); });
+        return;
+    }
+    m_input_scheduled = false;
+    m_input_done_condvar.notify_all();
+}
+
+void asst::Controller::stop_input()
+{
+    std::unique_lock<std::mutex> lock(m_input_mutex);
+    m_input_exit = true;
+    m_input_condvar.notify_all();
+    m_input_done_condvar.notify_all();
+    m_input_done_condvar.wait(lock, [&]() { return !m_input_scheduled; });
+    lock.unlock();
+
+    if (m_input_thread.joinable()) {
+        m_input_thread.join();
+    }
+}
+
+bool asst::Controller::wait_input(InputToken token)
+{
+    // 还没开始执行的输入直接在当前线程执行，不必等后台
+    while (run_next_input(token)) {
+    }
+
+    std::unique_lock<std::mutex> lock(m_input_mutex);
+    m_input_done_condvar.wait(lock, [&]() { return m_input_completed >= token || m_input_exit; });
+    if (m_input_completed < token) {
+        return false;
+    }
+
+    // 太早的记录已经丢弃，此时认为成功且不用再等
+    const InputToken distance = m_input_completed - token;
+    if (token == 0 || distance >= m_input_records.size()) {
+        return true;
+    }
+    return m_input_records[m_input_records.size() - 1 - distance].ret;
+}
+
+asst::PerfStats* asst::Controller::perf_stats() const
+{
+    return m_inst ? &m_inst->perf_stats() : nullptr;
+}
+
+void asst::Controller::wait_input_idle()
+{
+    InputToken token = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_input_mutex);
+        token = m_input_submitted;
+    }
+    std::ignore = wait_input(token);
+}
+
 cv::Mat asst::Controller::get_resized_image_cache() const
+{
+    uint64_t frame_seq = 0;
+    return get_resized_image_cache(frame_seq);
+}
+
+cv::Mat asst::Controller::get_resized_image_cache(uint64_t& frame_seq) const
 {
     const static cv::Size d_size(m_scale_size.first, m_scale_size.second);
 
     std::shared_lock<std::shared_mutex> image_lock(m_image_mutex);
+    frame_seq = m_image_seq;
     if (m_cache_image.empty()) {
         Log.error("image is empty");
         return { d_size, CV_8UC3 };
@@ -152,25 +309,29 @@ cv::Mat asst::Controller::get_resized_image_cache() const
 bool asst::Controller::start_game(const std::string& client_type)
 {
     CHECK_EXIST(m_controller, false);
+    wait_input_idle();
     return m_controller->start_game(client_type);
 }
 
 bool asst::Controller::stop_game(const std::string& client_type)
 {
     CHECK_EXIST(m_controller, false);
+    wait_input_idle();
     return m_controller->stop_game(client_type);
 }
 
 bool asst::Controller::click(const Point& p)
 {
     CHECK_EXIST(m_controller, false);
-    return m_scale_proxy->click(p);
+    CHECK_EXIST(m_scale_proxy, false);
+    return wait_input(post_input("click", [p, proxy = m_scale_proxy]() { return proxy->click(p); }));
 }
 
 bool asst::Controller::click(const Rect& rect)
 {
     CHECK_EXIST(m_controller, false);
-    return m_scale_proxy->click(rect);
+    CHECK_EXIST(m_scale_proxy, false);
+    return wait_input(post_input("click", [rect, proxy = m_scale_proxy]() { return proxy->click(rect); }));
 }
 
 bool asst::Controller::swipe(
@@ -183,7 +344,9 @@ bool asst::Controller::swipe(
     bool with_pause)
 {
     CHECK_EXIST(m_controller, false);
-    return m_scale_proxy->swipe(p1, p2, duration, extra_swipe, slope_in, slope_out, with_pause);
+    return wait_input(post_input("swipe", [=, proxy = m_scale_proxy]() {
+        return proxy->swipe(p1, p2, duration, extra_swipe, slope_in, slope_out, with_pause);
+    }));
 }
 
 bool asst::Controller::swipe(
@@ -196,13 +359,48 @@ bool asst::Controller::swipe(
     bool with_pause)
 {
     CHECK_EXIST(m_controller, false);
-    return m_scale_proxy->swipe(r1, r2, duration, extra_swipe, slope_in, slope_out, with_pause);
+    CHECK_EXIST(m_scale_proxy, false);
+    return wait_input(post_input("swipe", [=, proxy = m_scale_proxy]() {
+        return proxy->swipe(r1, r2, duration, extra_swipe, slope_in, slope_out, with_pause);
+    }));
 }
 
 bool asst::Controller::inject_input_event(InputEvent& event)
 {
     CHECK_EXIST(m_controller, false);
-    return m_controller->inject_input_event(event);
+    return wait_input(post_input("inject_input_event", [event, controller = m_controller]() {
+        return controller->inject_input_event(event);
+    }));
+}
+
+asst::Controller::InputToken asst::Controller::click_async(const Point& p)
+{
+    CHECK_EXIST(m_scale_proxy, post_input("click", nullptr));
+    return post_input("click", [p, proxy = m_scale_proxy]() { return proxy->click(p); }, true);
+}
+
+asst::Controller::InputToken asst::Controller::click_async(const Rect& rect)
+{
+    CHECK_EXIST(m_scale_proxy, post_input("click", nullptr));
+    return post_input("click", [rect, proxy = m_scale_proxy]() { return proxy->click(rect); }, true);
+}
+
+asst::Controller::InputToken asst::Controller::swipe_async(
+    const Rect& r1,
+    const Rect& r2,
+    int duration,
+    bool extra_swipe,
+    double slope_in,
+    double slope_out,
+    bool with_pause)
+{
+    CHECK_EXIST(m_scale_proxy, post_input("swipe", nullptr));
+    return post_input(
+        "swipe",
+        [=, proxy = m_scale_proxy]() {
+            return proxy->swipe(r1, r2, duration, extra_swipe, slope_in, slope_out, with_pause);
+        },
+        true);
 }
 
 bool asst::Controller::press_esc()
@@ -210,7 +408,7 @@ bool asst::Controller::press_esc()
     LogTraceFunction;
 
     CHECK_EXIST(m_controller, false);
-    return m_controller->press_esc();
+    return wait_input(post_input("press_esc", [controller = m_controller]() { return controller->press_esc(); }));
 }
 
 asst::ControlFeat::Feat asst::Controller::support_features()
@@ -226,6 +424,8 @@ bool asst::Controller::connect(
 {
     LogTraceFunction;
 
+    // 旧连接上还没执行完的输入先跑完，再换控制器
+    wait_input_idle();
     clear_info();
 
     m_controller = create_controller(m_controller_type, adb_path, address, config, m_platform_type);
@@ -363,7 +563,9 @@ cv::Mat asst::Controller::get_image(bool raw)
         callback(AsstMsg::ConnectionInfo, info);
 
         const static cv::Size d_size(m_scale_size.first, m_scale_size.second);
+        std::unique_lock<std::shared_mutex> image_lock(m_image_mutex);
         m_cache_image = cv::Mat(d_size, CV_8UC3);
+        ++m_image_seq;
 
         break;
     }
@@ -382,9 +584,21 @@ cv::Mat asst::Controller::get_image_cache() const
     return get_resized_image_cache();
 }
 
+cv::Mat asst::Controller::get_image_cache(uint64_t& frame_seq) const
+{
+    return get_resized_image_cache(frame_seq);
+}
+
 bool asst::Controller::screencap(bool allow_reconnect)
 {
     CHECK_EXIST(m_controller, false);
+    // 保证截到的是已提交输入生效之后的画面
+    wait_input_idle();
+    PerfStats::Scope perf_scope(perf_stats(), PerfStats::Category::Controller, "screencap");
     std::unique_lock<std::shared_mutex> image_lock(m_image_mutex);
-    return m_controller->screencap(m_cache_image, allow_reconnect);
+    if (!m_controller->screencap(m_cache_image, allow_reconnect)) {
+        return false;
+    }
+    ++m_image_seq;
+    return true;
 }
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <queue>
 #include <random>
 #include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 
 #ifdef _WIN32
@@ -21,6 +29,7 @@
 #include "Common/AsstMsg.h"
 #include "Common/AsstTypes.h"
 #include "InstHelper.h"
+#include "PerfStats.h"
 #include "Utils/NoWarningCVMat.h"
 #include "Utils/SingletonHolder.hpp"
 #include "adb-lite/client.hpp"
@@ -62,6 +71,9 @@ public:
 
     cv::Mat get_image(bool raw = false);
     cv::Mat get_image_cache() const;
+    cv::Mat get_image_cache(uint64_t& frame_seq) const;
+    // 截图序号，每次截图成功后递增，0 表示还没有截图
+    uint64_t get_image_seq() const noexcept { return m_image_seq; }
     bool screencap(bool allow_reconnect = false);
 
     bool start_game(const std::string& client_type);
@@ -89,6 +101,26 @@ public:
 
     bool inject_input_event(InputEvent& event);
 
+    // 异步输入：提交后立即返回，在后台按提交顺序执行；截图前会等已提交的输入全部执行完
+    // 后台执行者按需创建：开启共享线程池时投递到 InstanceHost，否则第一次异步输入时才启动输入线程
+    // 同步输入和等待输入时，排在前面还没开始的输入直接在当前线程执行，不依赖后台
+    using InputToken = uint64_t;
+    InputToken click_async(const Point& p);
+    InputToken click_async(const Rect& rect);
+    InputToken swipe_async(
+        const Rect& r1,
+        const Rect& r2,
+        int duration = 0,
+        bool extra_swipe = false,
+        double slope_in = 1,
+        double slope_out = 1,
+        bool with_pause = false);
+    // 等待 token 对应的输入执行完，返回该输入是否成功。之后的延时请用可中断的 sleep
+    bool wait_input(InputToken token);
+    void wait_input_idle();
+    // 停止后台执行并等它退出，实例退出共享线程池前需调用
+    void stop_input();
+
     bool press_esc();
     ControlFeat::Feat support_features();
 
@@ -101,6 +133,29 @@ public:
 
 private:
     cv::Mat get_resized_image_cache() const;
+    cv::Mat get_resized_image_cache(uint64_t& frame_seq) const;
+
+    struct InputItem
+    {
+        std::string_view op; // 耗时统计中的名字，需为字面量
+        std::function<bool()> func;
+    };
+
+    struct InputRecord
+    {
+        bool ret = false;
+    };
+
+    static constexpr size_t InputRecordSize = 64;
+
+    // run_async 为 false 时只排队，由随后的 wait_input 在当前线程执行
+    InputToken post_input(std::string_view op, std::function<bool()> func, bool run_async = false);
+    void start_input_runner(); // 调用时需持有 m_input_mutex
+    // 取出并执行一个序号不超过 until 的输入，没有可执行的返回 false
+    bool run_next_input(InputToken until);
+    void input_proc();
+    void input_job();
+    PerfStats* perf_stats() const;
 
     void clear_info() noexcept;
     void callback(AsstMsg msg, const json::value& details);
@@ -127,5 +182,18 @@ private:
 
     mutable std::shared_mutex m_image_mutex;
     cv::Mat m_cache_image;
+    std::atomic<uint64_t> m_image_seq = 0;
+
+    std::mutex m_input_exec_mutex; // 取出并执行输入时持有，保证输入不并发、不乱序
+    std::mutex m_input_mutex;
+    std::condition_variable m_input_condvar;
+    std::condition_variable m_input_done_condvar;
+    std::queue<InputItem> m_input_queue;
+    InputToken m_input_submitted = 0;
+    InputToken m_input_completed = 0;
+    std::deque<InputRecord> m_input_records; // 最近完成的输入，末尾对应 m_input_completed
+    bool m_input_exit = false;
+    bool m_input_scheduled = false; // 共享线程池中是否已有本实例的输入任务
+    std::thread m_input_thread;
 };
 } // namespace asst
@@ -13,6 +13,17 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
+#include <random>
+
+#ifdef _WIN32
+#include "Utils/Platform/SafeWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "Config/GeneralConfig.h"
 #include "Utils/NoWarningCV.h"
 
@@ -63,6 +74,7 @@ bool asst::MaaThriftController::connect([[maybe_unused]] const std::string& adb_
     using namespace apache::thrift;
 
     std::shared_ptr<transport::TSocket> socket;
+    bool same_host = false;
 
     auto param_json = json::parse(config);
     if (!param_json.has_value()) {
@@ -83,6 +95,7 @@ bool asst::MaaThriftController::connect([[maybe_unused]] const std::string& adb_
             auto host = param_json->at("param").at("host").as_string();
             auto port = param_json->at("param").at("port").as_integer();
             socket = std::make_shared<transport::TSocket>(host, port);
+            same_host = host == "127.0.0.1" || host == "localhost" || host == "::1";
         }
         else {
             config_error();
@@ -93,6 +106,7 @@ bool asst::MaaThriftController::connect([[maybe_unused]] const std::string& adb_
         if (param_json->at("param").is_string()) {
             auto path = param_json->at("param").as_string();
             socket = std::make_shared<transport::TSocket>(path);
+            same_host = true;
         }
         else {
             config_error();
@@ -227,6 +241,11 @@ bool asst::MaaThriftController::connect([[maybe_unused]] const std::string& adb_
         }
     }
 
+    // 服务端在同一台机器上时，截图改走共享内存；可以用 "shared_memory": false 关掉
+    if (same_host && param_json->get("shared_memory", true) && init_shared_memory()) {
+        Log.info("screencap by shared memory:", m_shared_memory.name());
+    }
+
     {
         json::value info = get_info_json() | json::object {
             { "what", "Connected" },
@@ -260,6 +279,13 @@ bool asst::MaaThriftController::screencap(cv::Mat& image_payload, [[maybe_unused
         return false;
     }
 
+    if (m_shared_slot_size > 0) {
+        if (screencap_by_shared_memory(image_payload)) {
+            return true;
+        }
+        Log.warn("screencap by shared memory failed, fallback to thrift");
+    }
+
     ThriftController::CustomImage img;
     try {
         client_->screencap(img);
@@ -498,6 +524,9 @@ void asst::MaaThriftController::clear_info() noexcept
     close();
     client_.reset();
     transport_.reset();
+    m_shared_memory.destroy();
+    m_shared_slot_size = 0;
+    m_shared_seq = 0;
 }
 
 void asst::MaaThriftController::callback(AsstMsg msg, const json::value& details)
@@ -572,6 +601,149 @@ void asst::MaaThriftController::toucher_wait(const int delay)
     std::this_thread::sleep_for(std::chrono::milliseconds(delay));
 }
 
+bool asst::MaaThriftController::init_shared_memory()
+{
+    static std::atomic<unsigned> shared_memory_index = 0;
+
+    // 每个槽放得下一帧 4 通道的图
+    const size_t slot_size = static_cast<size_t>(m_screen_size.first) * m_screen_size.second * 4;
+    const std::string name = "maa-thrift-" + std::to_string(std::random_device {}()) + "-" +
+                             std::to_string(shared_memory_index++);
+    if (!m_shared_memory.create(name, slot_size * SharedMemorySlotCount)) {
+        return false;
+    }
+
+    ThriftController::SharedMemoryParam param;
+    param.name = m_shared_memory.name();
+    param.slot_count = SharedMemorySlotCount;
+    param.slot_size = static_cast<int64_t>(slot_size);
+
+    bool ret = false;
+    try {
+        ret = client_->attach_shared_memory(param);
+    }
+    catch (const std::exception& e) {
+        // 旧版本的服务端没有这个接口
+        Log.info("Cannot attach shared memory:", e.what());
+    }
+    if (!ret) {
+        m_shared_memory.destroy();
+        return false;
+    }
+
+    m_shared_slot_size = slot_size;
+    m_shared_seq = 0;
+    return true;
+}
+
+bool asst::MaaThriftController::screencap_by_shared_memory(cv::Mat& image_payload)
+{
+    ThriftController::SharedImage img;
+    try {
+        client_->screencap_shared(img);
+    }
+    catch (const std::exception& e) {
+        Log.error("Cannot get shared screencap:", e.what());
+        return false;
+    }
+
+    if (img.slot < 0 || img.slot >= SharedMemorySlotCount || img.size.width <= 0 || img.size.height <= 0) {
+        Log.error("invalid shared image, slot:", img.slot, ", size:", img.size.width, img.size.height);
+        return false;
+    }
+    if (img.seq <= m_shared_seq) {
+        Log.warn("shared image seq is not increasing:", m_shared_seq, "->", img.seq);
+    }
+    m_shared_seq = img.seq;
+
+    auto* slot_data = static_cast<uchar*>(m_shared_memory.data()) + m_shared_slot_size * img.slot;
+    cv::Mat orig_mat(img.size.height, img.size.width, img.type, slot_data);
+    if (orig_mat.total() * orig_mat.elemSize() > m_shared_slot_size) {
+        Log.error("shared image is larger than the slot:", img.size.width, img.size.height, img.type);
+        return false;
+    }
+    // 槽会被下一帧覆盖，拷出来
+    orig_mat.copyTo(image_payload);
+    return true;
+}
+
+asst::MaaThriftController::SharedMemory::~SharedMemory()
+{
+    destroy();
+}
+
+bool asst::MaaThriftController::SharedMemory::create(const std::string& name, size_t size)
+{
+    destroy();
+
+#ifdef _WIN32
+    std::string full_name = "Local\\" + name;
+    HANDLE handle = CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+        static_cast<DWORD>(size & 0xFFFFFFFF),
+        full_name.c_str());
+    if (handle == nullptr) {
+        Log.error("CreateFileMapping failed, error:", GetLastError());
+        return false;
+    }
+    void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (data == nullptr) {
+        Log.error("MapViewOfFile failed, error:", GetLastError());
+        CloseHandle(handle);
+        return false;
+    }
+    m_handle = handle;
+#else
+    std::string full_name = "/" + name;
+    int fd = shm_open(full_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        Log.error("shm_open failed, errno:", errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        Log.error("ftruncate failed, errno:", errno);
+        ::close(fd);
+        shm_unlink(full_name.c_str());
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        Log.error("mmap failed, errno:", errno);
+        shm_unlink(full_name.c_str());
+        return false;
+    }
+#endif
+
+    m_name = std::move(full_name);
+    m_data = data;
+    m_size = size;
+    return true;
+}
+
+void asst::MaaThriftController::SharedMemory::destroy() noexcept
+{
+    if (!m_data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_handle);
+    m_handle = nullptr;
+#else
+    munmap(m_data, m_size);
+    shm_unlink(m_name.c_str());
+#endif
+
+    m_name.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
 void asst::MaaThriftController::close()
 {
     if (transport_) {
@@ -96,6 +96,43 @@ namespace asst
         };
 
     private:
+        // 客户端创建、服务端写入的共享内存，同主机时截图数据不再经过 Thrift 序列化
+        class SharedMemory
+        {
+        public:
+            SharedMemory() = default;
+            SharedMemory(const SharedMemory&) = delete;
+            SharedMemory(SharedMemory&&) = delete;
+            ~SharedMemory();
+
+            bool create(const std::string& name, size_t size);
+            void destroy() noexcept;
+
+            const std::string& name() const noexcept { return m_name; }
+            void* data() const noexcept { return m_data; }
+            size_t size() const noexcept { return m_size; }
+
+            SharedMemory& operator=(const SharedMemory&) = delete;
+            SharedMemory& operator=(SharedMemory&&) = delete;
+
+        private:
+            std::string m_name;
+            void* m_data = nullptr;
+            size_t m_size = 0;
+#ifdef _WIN32
+            void* m_handle = nullptr;
+#endif
+        };
+
+        static constexpr int SharedMemorySlotCount = 2;
+
+        bool init_shared_memory();
+        bool screencap_by_shared_memory(cv::Mat& image_payload);
+
+        SharedMemory m_shared_memory;
+        size_t m_shared_slot_size = 0;
+        int64_t m_shared_seq = 0;
+
         static constexpr int MinimalVersion = 2;
         void close();
         bool open();
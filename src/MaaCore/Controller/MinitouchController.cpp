@@ -1,6 +1,7 @@
 #include "MinitouchController.h"
 
 #include <future>
+#include <vector>
 
 #include "Common/AsstTypes.h"
 #include "Config/GeneralConfig.h"
@@ -140,7 +141,8 @@ bool asst::MinitouchController::click(const Point& p)
     }
 
     Log.trace(m_use_maa_touch ? "maatouch" : "minitouch", "click:", p);
-    bool ret = m_minitoucher->down(p.x, p.y) && m_minitoucher->up();
+    m_minitoucher->begin_batch();
+    bool ret = m_minitoucher->down(p.x, p.y) && m_minitoucher->up() && m_minitoucher->flush();
     if (ret) m_minitoucher->extra_sleep();
     return ret;
 }
@@ -164,27 +166,40 @@ bool asst::MinitouchController::swipe(const Point& p1, const Point& p2, int dura
     }
 
     Log.trace(m_use_maa_touch ? "maatouch" : "minitouch", "swipe", p1, p2, duration, extra_swipe, slope_in, slope_out);
+    bool need_pause = with_pause && use_swipe_with_pause();
+    // 整个手势编成一段脚本，最后一次写入；非 maatouch 的暂停依赖实时的 ESC，只能逐条写入
+    if (!need_pause || m_use_maa_touch) {
+        m_minitoucher->begin_batch();
+    }
     if (!m_minitoucher->down(x1, y1)) return false;
 
     constexpr int TimeInterval = Minitoucher::DefaultSwipeDelay;
 
-    auto cubic_spline = [](double slope_0, double slope_1, double t) {
-        const double a = slope_0;
-        const double b = -(2 * slope_0 + slope_1 - 3);
-        const double c = -(-slope_0 - slope_1 + 2);
-        return a * t + b * std::pow(t, 2) + c * std::pow(t, 3);
-    }; // TODO: move this to math.hpp
+    // 三次样条 a*t + b*t^2 + c*t^3 在各采样时刻的值，按秦九韶算法预先算好
+    const double spline_a = slope_in;
+    const double spline_b = -(2 * slope_in + slope_out - 3);
+    const double spline_c = -(-slope_in - slope_out + 2);
+    auto make_progress_table = [&](int _duration) {
+        std::vector<double> table;
+        table.reserve(_duration / TimeInterval + 1);
+        for (int cur_time = TimeInterval; cur_time < _duration; cur_time += TimeInterval) {
+            const double t = static_cast<double>(cur_time) / _duration;
+            table.emplace_back(t * (spline_a + t * (spline_b + t * spline_c)));
+        }
+        return table;
+    };
 
-    bool need_pause = with_pause && use_swipe_with_pause();
     const auto& opt = Config.get_options();
+    const double pause_distance_square =
+        static_cast<double>(opt.swipe_with_pause_required_distance) * opt.swipe_with_pause_required_distance;
     std::future<void> pause_future;
     auto minitouch_move = [&](int _x1, int _y1, int _x2, int _y2, int _duration) -> bool {
-        for (int cur_time = TimeInterval; cur_time < _duration; cur_time += TimeInterval) {
-            double progress = cubic_spline(slope_in, slope_out, static_cast<double>(cur_time) / duration);
+        for (double progress : make_progress_table(_duration)) {
             int cur_x = static_cast<int>(std::lerp(_x1, _x2, progress));
             int cur_y = static_cast<int>(std::lerp(_y1, _y2, progress));
-            if (need_pause && std::sqrt(std::pow(cur_x - _x1, 2) + std::pow(cur_y - _y1, 2)) >
-                                  opt.swipe_with_pause_required_distance) {
+            const double dx = cur_x - _x1;
+            const double dy = cur_y - _y1;
+            if (need_pause && dx * dx + dy * dy > pause_distance_square) {
                 need_pause = false;
                 if (m_use_maa_touch) {
                     constexpr int EscKeyCode = 111;
@@ -214,6 +229,7 @@ bool asst::MinitouchController::swipe(const Point& p1, const Point& p2, int dura
             return false;
     }
     if (!m_minitoucher->up()) return false;
+    if (!m_minitoucher->flush()) return false;
     m_minitoucher->extra_sleep();
     return true;
 }
@@ -227,6 +243,8 @@ bool asst::MinitouchController::inject_input_event(const InputEvent& event)
         return false;
     }
 
+    // 与 MaaThriftController 一致，事件先攒着，直到 COMMIT 再一次写入
+    m_minitoucher->begin_batch();
     switch (event.type) {
     case InputEvent::Type::KEY_DOWN:
         return m_minitoucher->key_down(event.keycode, 0, false);
@@ -243,7 +261,7 @@ bool asst::MinitouchController::inject_input_event(const InputEvent& event)
     case InputEvent::Type::WAIT_MS:
         return m_minitoucher->wait(event.milisec);
     case InputEvent::Type::COMMIT:
-        return m_minitoucher->commit();
+        return m_minitoucher->commit() && m_minitoucher->flush();
     case InputEvent::Type::UNKNOWN:
     default:
         Log.error("unknown input event type");
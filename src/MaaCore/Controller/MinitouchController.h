@@ -88,36 +88,57 @@ namespace asst
             ~Minitoucher() = default;
 
             // nodiscard! for false return value may indicating *this got replaced in m_input_func
-            [[nodiscard]] bool reset() { return m_input_func(reset_cmd()); }
-            [[nodiscard]] bool commit() { return m_input_func(commit_cmd()); }
+            [[nodiscard]] bool reset() { return input(reset_cmd()); }
+            [[nodiscard]] bool commit() { return input(commit_cmd()); }
             [[nodiscard]] bool down(int x, int y, int wait_ms = DefaultClickDelay, bool with_commit = true,
                                     int contact = 0)
             {
-                return m_input_func(down_cmd(x, y, wait_ms, with_commit, contact));
+                return input(down_cmd(x, y, wait_ms, with_commit, contact));
             }
             [[nodiscard]] bool move(int x, int y, int wait_ms = DefaultSwipeDelay, bool with_commit = true,
                                     int contact = 0)
             {
-                return m_input_func(move_cmd(x, y, wait_ms, with_commit, contact));
+                return input(move_cmd(x, y, wait_ms, with_commit, contact));
             }
             [[nodiscard]] bool up(int wait_ms = DefaultClickDelay, bool with_commit = true, int contact = 0)
             {
-                return m_input_func(up_cmd(wait_ms, with_commit, contact));
+                return input(up_cmd(wait_ms, with_commit, contact));
             }
             [[nodiscard]] bool key_down(int key_code, int wait_ms = DefaultClickDelay, bool with_commit = true)
             {
-                return m_input_func(key_down_cmd(key_code, wait_ms, with_commit));
+                return input(key_down_cmd(key_code, wait_ms, with_commit));
             }
             [[nodiscard]] bool key_up(int key_code, int wait_ms = DefaultClickDelay, bool with_commit = true)
             {
-                return m_input_func(key_up_cmd(key_code, wait_ms, with_commit));
+                return input(key_up_cmd(key_code, wait_ms, with_commit));
+            }
+            [[nodiscard]] bool wait(int ms) { return input(wait_cmd(ms)); }
+            // 开启后命令先写进缓冲区，flush 时整段手势一次写入，时序由设备端的 w 命令保证
+            void begin_batch() noexcept { m_batching = true; }
+            [[nodiscard]] bool flush()
+            {
+                m_batching = false;
+                if (m_batch.empty()) {
+                    return true;
+                }
+                std::string cmds = std::move(m_batch);
+                m_batch.clear();
+                return m_input_func(cmds);
             }
-            [[nodiscard]] bool wait(int ms) { return m_input_func(wait_cmd(ms)); }
             void clear() noexcept { m_wait_ms_count = 0; }
 
             void extra_sleep() { sleep(); }
 
         private:
+            [[nodiscard]] bool input(const std::string& cmd)
+            {
+                if (m_batching) {
+                    m_batch += cmd;
+                    return true;
+                }
+                return m_input_func(cmd);
+            }
+
             [[nodiscard]] std::string reset_cmd() const noexcept { return "r\n"; }
             [[nodiscard]] std::string commit_cmd() const noexcept { return "c\n"; }
 #ifdef _MSC_VER
@@ -235,6 +256,8 @@ namespace asst
             const std::function<bool(const std::string&)> m_input_func = nullptr;
             const MinitouchProps& m_props;
             int m_wait_ms_count = ExtraDelay;
+            bool m_batching = false;
+            std::string m_batch;
         };
     };
 } // namespace asst
@@ -2,6 +2,8 @@
 
 #include <regex>
 
+#include "Assistant.h"
+#include "InstanceHost.h"
 #include "Utils/Logger.hpp"
 
 std::optional<int> asst::AdbLiteIO::call_command(const std::string& cmd, bool recv_by_socket, std::string& pipe_data,
@@ -59,7 +61,16 @@ std::optional<int> asst::AdbLiteIO::call_command(const std::string& cmd, bool re
     // adb connect
     // TODO: adb server 尚未实现，第一次连接需要执行一次 adb.exe 启动 daemon
     if (std::regex_match(cmd, match, connect_regex)) {
-        m_adb_client = adb::client::create(match[1].str()); // TODO: compare address with existing (if any)
+        // TODO: compare address with existing (if any)
+        if (m_assistant && m_assistant->shared_workers()) {
+            // 连接池的补充交给共享线程池，不再单独起线程
+            m_adb_client = adb::client::create(match[1].str(), [](std::function<void()> job) {
+                InstanceHost::get_instance().post(std::move(job));
+            });
+        }
+        else {
+            m_adb_client = adb::client::create(match[1].str());
+        }
 
         try {
             pipe_data = m_adb_client->connect();
@@ -86,7 +97,7 @@ std::optional<int> asst::AdbLiteIO::call_command(const std::string& cmd, bool re
         remove_quotes(command);
 
         try {
-            pipe_data = m_adb_client->shell(command);
+            m_adb_client->shell(command, pipe_data);
             ret = 0;
             goto ret_exit;
         }
@@ -109,7 +120,7 @@ std::optional<int> asst::AdbLiteIO::call_command(const std::string& cmd, bool re
         remove_quotes(command);
 
         try {
-            pipe_data = m_adb_client->exec(command);
+            m_adb_client->exec(command, pipe_data);
             ret = 0;
             goto ret_exit;
         }
@@ -22,7 +22,7 @@ namespace asst
     class AdbLiteIO : public NativeIO
     {
     public:
-        AdbLiteIO(Assistant* inst) : NativeIO(inst) {};
+        AdbLiteIO(Assistant* inst) : NativeIO(inst), m_assistant(inst) {};
         AdbLiteIO(const AdbLiteIO&) = delete;
         AdbLiteIO(AdbLiteIO&&) = delete;
         virtual ~AdbLiteIO() = default;
@@ -38,6 +38,7 @@ namespace asst
     private:
         static bool remove_quotes(std::string& data);
 
+        Assistant* m_assistant = nullptr; // NativeIO 私有继承了 InstHelper，这里单独保存
         std::shared_ptr<adb::client> m_adb_client = nullptr;
     };
 
@@ -68,8 +68,7 @@ bool asst::PlayToolsController::screencap(
     uint32_t image_size = 0;
 
     try {
-        constexpr char request[6] = { 0, 4, 'S', 'C', 'R', 'N' };
-        asio::write(m_socket, asio::buffer(request));
+        send_request("SCRN");
         asio::read(m_socket, asio::buffer(&image_size, sizeof(image_size)));
         image_size = socket_ops::network_to_host_long(image_size);
     }
@@ -78,16 +77,22 @@ bool asst::PlayToolsController::screencap(
         return false;
     }
 
-    if (image_size == 0) {
-        Log.error("Cannot get screencap: invalid image size");
+    // 数据不够一整帧时没法解析，后面的流也对不上了，断开重连
+    const size_t expected_size = 4ULL * m_screen_size.first * m_screen_size.second;
+    if (image_size == 0 || image_size < expected_size) {
+        Log.error("Cannot get screencap: invalid image size", image_size);
+        close();
         return false;
     }
 
     try {
-        std::vector<uint8_t> buffer(image_size);
-        asio::read(m_socket, asio::buffer(buffer, image_size));
-        image_payload = cv::Mat(m_screen_size.second, m_screen_size.first, CV_8UC4, buffer.data());
-        cv::cvtColor(image_payload, image_payload, cv::COLOR_RGBA2BGR);
+        // 缓冲区复用，只在变大时重新分配
+        if (m_screencap_buffer.size() < image_size) {
+            m_screencap_buffer.resize(image_size);
+        }
+        asio::read(m_socket, asio::buffer(m_screencap_buffer.data(), image_size));
+        cv::Mat rgba(m_screen_size.second, m_screen_size.first, CV_8UC4, m_screencap_buffer.data());
+        cv::cvtColor(rgba, image_payload, cv::COLOR_RGBA2BGR);
     }
     catch (const std::exception& e) {
         Log.error("Cannot get screencap:", e.what());
@@ -105,8 +110,7 @@ bool asst::PlayToolsController::start_game(const std::string& client_type [[mayb
 bool asst::PlayToolsController::stop_game(const std::string& client_type [[maybe_unused]])
 {
     try {
-        constexpr char request[6] = { 0, 4, 'T', 'E', 'R', 'M' };
-        asio::write(m_socket, asio::buffer(request));
+        send_request("TERM");
     }
     catch (const std::exception& e) {
         Log.error("Cannot terminate game:", e.what());
@@ -256,6 +260,8 @@ bool asst::PlayToolsController::open()
 
     try {
         asio::connect(m_socket, resolver.resolve(host, port));
+        // 请求都很小，不等 Nagle 攒包
+        m_socket.set_option(tcp::no_delay(true));
         asio::write(m_socket, asio::buffer(handshake));
         asio::read(m_socket, asio::buffer(buffer, 4));
     }
@@ -275,10 +281,9 @@ bool asst::PlayToolsController::open()
 bool asst::PlayToolsController::check_version()
 {
     uint32_t version = 0;
-    constexpr char request[6] = { 0, 4, 'V', 'E', 'R', 'N' };
 
     try {
-        asio::write(m_socket, asio::buffer(request));
+        send_request("VERN");
         asio::read(m_socket, asio::buffer(&version, sizeof(version)));
     }
     catch (const std::exception& e) {
@@ -305,10 +310,9 @@ bool asst::PlayToolsController::check_version()
 bool asst::PlayToolsController::fetch_screen_res()
 {
     uint16_t width = 0, height = 0;
-    constexpr char request[6] = { 0, 4, 'S', 'I', 'Z', 'E' };
 
     try {
-        asio::write(m_socket, asio::buffer(request));
+        send_request("SIZE");
         asio::read(m_socket, asio::buffer(&width, sizeof(width)));
         asio::read(m_socket, asio::buffer(&height, sizeof(height)));
     }
@@ -337,9 +341,7 @@ bool asst::PlayToolsController::toucher_commit(
     std::memcpy(payload + 3, &y, sizeof(y));
 
     try {
-        constexpr char request[6] = { 0, 9, 'T', 'U', 'C', 'H' };
-        asio::write(m_socket, asio::buffer(request));
-        asio::write(m_socket, asio::buffer(payload, 5));
+        send_request("TUCH", payload, sizeof(payload));
     }
     catch (const std::exception& e) {
         Log.error("Cannot touch screen:", e.what());
@@ -349,3 +351,15 @@ bool asst::PlayToolsController::toucher_commit(
     toucher_wait(delay);
     return true;
 }
+
+void asst::PlayToolsController::send_request(std::string_view name, const void* payload, size_t payload_size)
+{
+    // 长度 + 名字 + 参数，一次写出去
+    const uint16_t length = socket_ops::host_to_network_short(static_cast<uint16_t>(name.size() + payload_size));
+    std::array<asio::const_buffer, 3> buffers = {
+        asio::buffer(&length, sizeof(length)),
+        asio::buffer(name.data(), name.size()),
+        asio::buffer(payload, payload_size),
+    };
+    asio::write(m_socket, buffers);
+}
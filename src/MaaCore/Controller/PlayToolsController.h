@@ -3,6 +3,9 @@
 #include "ControllerAPI.h"
 #include "MinitouchController.h"
 
+#include <string_view>
+#include <vector>
+
 #include <asio/io_context.hpp>
 #include <asio/ip/tcp.hpp>
 
@@ -102,5 +105,8 @@ private:
     bool check_version();
     bool fetch_screen_res();
     bool toucher_commit(const TouchPhase phase, const Point& p, const int delay);
+    void send_request(std::string_view name, const void* payload = nullptr, size_t payload_size = 0);
+
+    std::vector<uint8_t> m_screencap_buffer;
 };
 } // namespace asst
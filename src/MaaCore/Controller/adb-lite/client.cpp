@@ -1,5 +1,9 @@
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
 #include <thread>
 
 #include <asio.hpp>
@@ -141,13 +145,16 @@ namespace adb
     class client_impl : public client
     {
     public:
-        client_impl(const std::string_view serial);
+        client_impl(const std::string_view serial, executor exec);
+        ~client_impl() override;
         std::string connect() override;
         std::string disconnect() override;
         std::string version() override;
         std::string devices() override;
         std::string shell(const std::string_view command) override;
+        void shell(const std::string_view command, std::string& output) override;
         std::string exec(const std::string_view command) override;
+        void exec(const std::string_view command, std::string& output) override;
         bool push(const std::string_view src, const std::string_view dst, int perm) override;
         std::shared_ptr<io_handle> interactive_shell(const std::string_view command) override;
         std::string root() override;
@@ -168,14 +175,60 @@ namespace adb
          * @note Local services (e.g. shell, push) can be requested after this.
          */
         void switch_to_device(asio::ip::tcp::socket& socket);
+
+        /// Number of idle connections kept for the device.
+        static constexpr size_t pool_size = 2;
+
+        std::mutex m_pool_mutex;
+        std::condition_variable m_pool_condvar;
+        std::deque<tcp::socket> m_pool;
+        uint64_t m_pool_generation = 0;
+        bool m_pool_wanted = false;
+        bool m_pool_exit = false;
+        bool m_refill_scheduled = false;
+        executor m_executor;
+        std::thread m_pool_thread;
+
+        /// Open a connection and request a device service on it.
+        /**
+         * @param request Service request, e.g. `shell:<command>`.
+         * @return The connection, ready to transfer the service data.
+         * @throw std::system_error if the server is not available.
+         * @note A pooled connection is used if there is one. If the server has
+         * closed it meanwhile, the request is retried on a new connection.
+         */
+        tcp::socket request_device_service(const std::string_view request);
+
+        /// Start refilling the pool if it is not full.
+        /**
+         * @note Should be called with `m_pool_mutex` held.
+         */
+        void schedule_refill();
+
+        /// Open a connection switched to the device, empty if it fails.
+        std::optional<tcp::socket> open_device_connection();
+
+        /// Keep the pool filled, running on `m_pool_thread`.
+        void refill_pool();
+
+        /// Fill the pool once, running on the executor.
+        void refill_job();
+
+        /// Drop the idle connections, e.g. when the device restarts.
+        void clear_pool();
     };
 
+    std::shared_ptr<client> client::create(const std::string_view serial, executor exec)
+    {
+        return std::make_shared<client_impl>(serial, std::move(exec));
+    }
+
     std::shared_ptr<client> client::create(const std::string_view serial)
     {
-        return std::make_shared<client_impl>(serial);
+        return std::make_shared<client_impl>(serial, nullptr);
     }
 
-    client_impl::client_impl(const std::string_view serial)
+    client_impl::client_impl(const std::string_view serial, executor exec) : m_executor(std::move(exec))
     {
         m_serial = serial;
 
@@ -183,8 +236,23 @@ namespace adb
         m_endpoints = resolver.resolve("127.0.0.1", "5037");
     }
 
+    client_impl::~client_impl()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_exit = true;
+            m_pool_condvar.notify_all();
+            m_pool_condvar.wait(lock, [&]() { return !m_refill_scheduled; });
+        }
+        if (m_pool_thread.joinable()) {
+            m_pool_thread.join();
+        }
+    }
+
     std::string client_impl::connect()
     {
+        clear_pool();
+
         tcp::socket socket(m_context);
         asio::connect(socket, m_endpoints);
 
@@ -196,6 +264,8 @@ namespace adb
 
     std::string client_impl::disconnect()
     {
+        clear_pool();
+
         tcp::socket socket(m_context);
         asio::connect(socket, m_endpoints);
 
@@ -217,40 +287,34 @@ namespace adb
 
     std::string client_impl::shell(const std::string_view command)
     {
-        tcp::socket socket(m_context);
-        asio::connect(socket, m_endpoints);
-
-        switch_to_device(socket);
-
-        const auto request = std::string("shell:") + command.data();
-        send_host_request(socket, request);
+        std::string output;
+        shell(command, output);
+        return output;
+    }
 
-        return protocol::host_data(socket);
+    void client_impl::shell(const std::string_view command, std::string& output)
+    {
+        auto socket = request_device_service(std::string("shell:") + command.data());
+        protocol::host_data(socket, output);
     }
 
     std::string client_impl::exec(const std::string_view command)
     {
-        tcp::socket socket(m_context);
-        asio::connect(socket, m_endpoints);
-
-        switch_to_device(socket);
-
-        const auto request = std::string("exec:") + command.data();
-        send_host_request(socket, request);
+        std::string output;
+        exec(command, output);
+        return output;
+    }
 
-        return protocol::host_data(socket);
+    void client_impl::exec(const std::string_view command, std::string& output)
+    {
+        auto socket = request_device_service(std::string("exec:") + command.data());
+        protocol::host_data(socket, output);
     }
 
     bool client_impl::push(const std::string_view src, const std::string_view dst, int perm)
     {
-        tcp::socket socket(m_context);
-        asio::connect(socket, m_endpoints);
-
-        switch_to_device(socket);
-
         // Switch to sync mode
-        const auto sync = "sync:";
-        send_host_request(socket, sync);
+        auto socket = request_device_service("sync:");
 
         // SEND request: destination, permissions
         const auto send_request = std::string(dst) + "," + std::to_string(perm);
@@ -286,28 +350,22 @@ namespace adb
 
     std::string client_impl::root()
     {
-        tcp::socket socket(m_context);
-        asio::connect(socket, m_endpoints);
+        auto socket = request_device_service("root:");
+        auto result = protocol::host_data(socket);
 
-        switch_to_device(socket);
-
-        const auto request = "root:";
-        send_host_request(socket, request);
-
-        return protocol::host_data(socket);
+        // adbd restarts, so the idle connections are no longer valid.
+        clear_pool();
+        return result;
     }
 
     std::string client_impl::unroot()
     {
-        tcp::socket socket(m_context);
-        asio::connect(socket, m_endpoints);
+        auto socket = request_device_service("unroot:");
+        auto result = protocol::host_data(socket);
 
-        switch_to_device(socket);
-
-        const auto request = "unroot:";
-        send_host_request(socket, request);
-
-        return protocol::host_data(socket);
+        // adbd restarts, so the idle connections are no longer valid.
+        clear_pool();
+        return result;
     }
 
     std::shared_ptr<io_handle> client_impl::interactive_shell(const std::string_view command)
@@ -340,4 +398,124 @@ namespace adb
         const auto request = "host:transport:" + m_serial;
         send_host_request(socket, request);
     }
+
+    tcp::socket client_impl::request_device_service(const std::string_view request)
+    {
+        std::optional<tcp::socket> pooled;
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_wanted = true;
+            if (!m_pool.empty()) {
+                pooled.emplace(std::move(m_pool.front()));
+                m_pool.pop_front();
+            }
+            schedule_refill();
+        }
+
+        if (pooled) {
+            try {
+                send_host_request(*pooled, request);
+                return std::move(*pooled);
+            }
+            catch (const std::system_error&) {
+                // The server closed the idle connection, fall through to a new one.
+            }
+        }
+
+        tcp::socket socket(m_context);
+        asio::connect(socket, m_endpoints);
+        switch_to_device(socket);
+        send_host_request(socket, request);
+        return socket;
+    }
+
+    void client_impl::schedule_refill()
+    {
+        if (m_pool_exit || m_pool.size() >= pool_size) {
+            return;
+        }
+        if (m_executor) {
+            if (!m_refill_scheduled) {
+                m_refill_scheduled = true;
+                m_executor([this]() { refill_job(); });
+            }
+            return;
+        }
+        if (!m_pool_thread.joinable()) {
+            m_pool_thread = std::thread(&client_impl::refill_pool, this);
+        }
+        m_pool_condvar.notify_one();
+    }
+
+    std::optional<tcp::socket> client_impl::open_device_connection()
+    {
+        // Blocking operations on different sockets are safe with a shared
+        // io_context, as long as it is not run concurrently.
+        try {
+            tcp::socket socket(m_context);
+            asio::connect(socket, m_endpoints);
+            switch_to_device(socket);
+            return socket;
+        }
+        catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    void client_impl::refill_pool()
+    {
+        std::unique_lock<std::mutex> lock(m_pool_mutex);
+        while (true) {
+            m_pool_condvar.wait(lock, [&]() { return m_pool_exit || (m_pool_wanted && m_pool.size() < pool_size); });
+            if (m_pool_exit) {
+                return;
+            }
+
+            const auto generation = m_pool_generation;
+            lock.unlock();
+
+            auto socket = open_device_connection();
+
+            lock.lock();
+            if (!socket) {
+                // The device is not available for now, retry on the next request.
+                m_pool_wanted = false;
+                continue;
+            }
+            if (generation == m_pool_generation) {
+                m_pool.emplace_back(std::move(*socket));
+            }
+        }
+    }
+
+    void client_impl::refill_job()
+    {
+        std::unique_lock<std::mutex> lock(m_pool_mutex);
+        while (!m_pool_exit && m_pool_wanted && m_pool.size() < pool_size) {
+            const auto generation = m_pool_generation;
+            lock.unlock();
+
+            auto socket = open_device_connection();
+
+            lock.lock();
+            if (!socket) {
+                // The device is not available for now, retry on the next request.
+                m_pool_wanted = false;
+                break;
+            }
+            if (generation == m_pool_generation) {
+                m_pool.emplace_back(std::move(*socket));
+            }
+        }
+        m_refill_scheduled = false;
+        m_pool_condvar.notify_all();
+    }
+
+    void client_impl::clear_pool()
+    {
+        std::unique_lock<std::mutex> lock(m_pool_mutex);
+        m_pool.clear();
+        ++m_pool_generation;
+        m_pool_wanted = false;
+    }
 } // namespace adb
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -65,6 +66,14 @@ namespace adb
     class client_impl;
 
     /// A client for the Android Debug Bridge.
+    /**
+     * @note The client keeps a few connections that have already switched to
+     * the device transport, so one-shot requests skip the connect and
+     * transport handshakes. A connection carries only one service request,
+     * which is how the adb server works, and the pool is refilled in the
+     * background, on the executor if one is given, otherwise on a thread
+     * started by the first device request.
+     */
     class client
     {
     public:
@@ -74,6 +83,15 @@ namespace adb
          * @note If the serial is empty, the unique device will be used. If there
          * are multiple devices, an exception will be thrown.
          */
+        /// Run a job in the background, e.g. on a shared thread pool.
+        using executor = std::function<void(std::function<void()>)>;
+
+        /**
+         * @param serial serial number of the device.
+         * @param exec runs the pool refill jobs. The client waits for its
+         * pending jobs on destruction, so they must eventually run.
+         */
+        static std::shared_ptr<client> create(const std::string_view serial, executor exec);
         static std::shared_ptr<client> create(const std::string_view serial);
         virtual ~client() = default;
 
@@ -121,6 +139,15 @@ namespace adb
          */
         virtual std::string shell(const std::string_view command) = 0;
 
+        /// Send an one-shot shell command to the device.
+        /**
+         * @param command Command to execute.
+         * @param output Buffer to receive the command output. Its capacity is
+         * reused, so callers may keep it across calls.
+         * @throw std::system_error if the server is not available.
+         */
+        virtual void shell(const std::string_view command, std::string& output) = 0;
+
         /// Send an one-shot shell command to the device, using raw PTY.
         /**
          * @param command Command to execute.
@@ -130,6 +157,15 @@ namespace adb
          */
         virtual std::string exec(const std::string_view command) = 0;
 
+        /// Send an one-shot shell command to the device, using raw PTY.
+        /**
+         * @param command Command to execute.
+         * @param output Buffer to receive the command output. Its capacity is
+         * reused, so callers may keep it across calls.
+         * @throw std::system_error if the server is not available.
+         */
+        virtual void exec(const std::string_view command, std::string& output) = 0;
+
         /// Send a file to the device.
         /**
          * @return true if the file is successfully sent.
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 
@@ -64,18 +65,24 @@ namespace adb::protocol
     std::string host_data(tcp::socket& socket)
     {
         std::string data;
-        std::array<char, 1024> buffer;
+        host_data(socket, data);
+        return data;
+    }
+
+    void host_data(tcp::socket& socket, std::string& data)
+    {
+        constexpr size_t chunk_size = 64 * 1024;
+        size_t received = 0;
         asio::error_code ec;
 
+        data.clear();
         while (!ec) {
-            const auto length = socket.read_some(asio::buffer(buffer), ec);
-            if (ec == asio::error::eof) {
-                break;
+            if (data.size() < received + chunk_size) {
+                data.resize(std::max(data.size() * 2, received + chunk_size));
             }
-            data.append(buffer.data(), length);
+            received += socket.read_some(asio::buffer(data.data() + received, data.size() - received), ec);
         }
-
-        return data;
+        data.resize(received);
     }
 
     std::string sync_request(const std::string_view id, const uint32_t length)
@@ -23,6 +23,16 @@ namespace adb::protocol
      */
     std::string host_data(asio::ip::tcp::socket& socket);
 
+    /// Receive all data from the host into a caller-provided buffer.
+    /**
+     * @param socket Opened adb connection.
+     * @param data Buffer to receive the data. Its capacity is reused.
+     * @throw std::runtime_error Thrown on socket failure.
+     * @note The function reads directly into `data` in large chunks, and
+     * keeps reading until the connection is closed.
+     */
+    void host_data(asio::ip::tcp::socket& socket, std::string& data);
+
     /// Encode the ADB sync request.
     /**
      * @param id 4-byte string of the request id.
@@ -30,6 +30,8 @@ bool asst::InstHelper::sleep(unsigned millisecond) const
         return true;
     }
     Log.trace("ready to sleep", millisecond);
+    PerfStats::Scope perf_scope(m_inst ? &m_inst->perf_stats() : PerfStats::current(), PerfStats::Category::Sleep,
+                                "sleep");
     auto millisecond_ms = std::chrono::milliseconds(millisecond);
     auto interval = std::chrono::milliseconds(std::min(millisecond, 5000U));
 
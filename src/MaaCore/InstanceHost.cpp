@@ -0,0 +1,128 @@
+#include "InstanceHost.h"
+
+#include "Utils/Logger.hpp"
+
+namespace
+{
+    thread_local bool s_in_worker_thread = false;
+}
+
+asst::InstanceHost::~InstanceHost()
+{
+    stop_workers();
+}
+
+bool asst::InstanceHost::set_worker_count(size_t count)
+{
+    LogTraceFunction;
+    Log.info("worker count:", count);
+
+    if (in_worker_thread()) {
+        Log.error("cannot change worker count from a worker thread");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> config_lock(m_config_mutex);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_instances != 0) {
+            Log.error("cannot change worker count while", m_instances, "instances are using it");
+            return false;
+        }
+    }
+
+    stop_workers();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_exit = false;
+    for (size_t i = 0; i < count; ++i) {
+        m_workers.emplace_back(&InstanceHost::worker_proc, this);
+    }
+    return true;
+}
+
+void asst::InstanceHost::post(Job job)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.emplace(std::move(job));
+    m_condvar.notify_one();
+}
+
+bool asst::InstanceHost::attach_instance()
+{
+    std::unique_lock<std::mutex> config_lock(m_config_mutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_workers.empty()) {
+        return false;
+    }
+    ++m_instances;
+    return true;
+}
+
+void asst::InstanceHost::detach_instance()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_instances > 0) {
+        --m_instances;
+    }
+}
+
+asst::InstanceHost::Stats asst::InstanceHost::get_stats() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return Stats {
+        .workers = m_workers.size(),
+        .instances = m_instances,
+        .pending_jobs = m_jobs.size(),
+        .finished_jobs = m_finished_jobs,
+    };
+}
+
+bool asst::InstanceHost::in_worker_thread() noexcept
+{
+    return s_in_worker_thread;
+}
+
+void asst::InstanceHost::worker_proc()
+{
+    LogTraceFunction;
+
+    s_in_worker_thread = true;
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_jobs.empty()) {
+            // 退出前先把已投递的任务跑完，实例的析构会等它们结束
+            if (m_exit) {
+                return;
+            }
+            m_condvar.wait(lock);
+            continue;
+        }
+
+        auto job = std::move(m_jobs.front());
+        m_jobs.pop();
+        lock.unlock();
+
+        job();
+
+        lock.lock();
+        ++m_finished_jobs;
+    }
+}
+
+void asst::InstanceHost::stop_workers()
+{
+    std::vector<std::thread> workers;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_exit = true;
+        m_condvar.notify_all();
+        workers.swap(m_workers);
+    }
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "Utils/SingletonHolder.hpp"
+
+namespace asst
+{
+    // 进程级的共享线程池，开启后各实例不再单独起回调线程和异步调用线程，
+    // 而是把这些工作投递到这里，一个进程带很多设备时能省下大量线程
+    class InstanceHost : public SingletonHolder<InstanceHost>
+    {
+    public:
+        using Job = std::function<void()>;
+
+        struct Stats
+        {
+            size_t workers = 0;
+            size_t instances = 0;
+            size_t pending_jobs = 0;
+            uint64_t finished_jobs = 0;
+        };
+
+        virtual ~InstanceHost() override;
+
+        // 设置线程数，0 为关闭。已有实例在用线程池时不能修改，也不能在线程池自己的线程里调用
+        bool set_worker_count(size_t count);
+        // 线程池开启时登记一个实例并返回 true，实例析构时要调用 detach_instance
+        bool attach_instance();
+        void detach_instance();
+
+        void post(Job job);
+
+        Stats get_stats() const;
+
+        // 当前线程是否是线程池的工作线程。在工作线程里阻塞等待投递到池里的任务可能会死锁
+        static bool in_worker_thread() noexcept;
+
+    private:
+        friend class SingletonHolder<InstanceHost>;
+        InstanceHost() = default;
+
+        void worker_proc();
+        void stop_workers();
+
+        // 修改线程数和登记实例都要持有，保证检查、停止和重新启动线程之间不会有实例登记进来
+        std::mutex m_config_mutex;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condvar;
+        std::queue<Job> m_jobs;
+        std::vector<std::thread> m_workers;
+        size_t m_instances = 0;
+        uint64_t m_finished_jobs = 0;
+        bool m_exit = false;
+    };
+} // namespace asst
@@ -0,0 +1,128 @@
+#include "PerfStats.h"
+
+#include <algorithm>
+
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+    thread_local asst::PerfStats* s_current = nullptr;
+}
+
+asst::PerfStats::Scope::Scope(PerfStats* stats, Category category, std::string_view name) noexcept
+    : m_stats(stats)
+    , m_category(category)
+    , m_name(name)
+{
+    if (m_stats) {
+        m_start = Clock::now();
+    }
+}
+
+asst::PerfStats::Scope::~Scope()
+{
+    if (!m_stats) {
+        return;
+    }
+    // 析构里不能抛出，统计失败（如内存不足）直接丢掉这一条
+    try {
+        m_stats->record(m_category, m_name, Clock::now() - m_start);
+    }
+    catch (...) {
+    }
+}
+
+asst::PerfStats::Binding::Binding(PerfStats* stats) noexcept : m_prev(s_current)
+{
+    s_current = stats;
+}
+
+asst::PerfStats::Binding::~Binding()
+{
+    s_current = m_prev;
+}
+
+asst::PerfStats* asst::PerfStats::current() noexcept
+{
+    return s_current;
+}
+
+void asst::PerfStats::record(Category category, std::string_view name, Clock::duration cost)
+{
+    using namespace std::chrono;
+
+    const int64_t cost_us = duration_cast<microseconds>(cost).count();
+    const size_t bucket =
+        ranges::lower_bound(BucketBoundsMs, cost_us, std::less {}, [](int64_t ms) { return ms * 1000; }) -
+        BucketBoundsMs.begin();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto& entries = m_entries[static_cast<size_t>(category)];
+    auto iter = entries.find(name);
+    if (iter == entries.end()) {
+        iter = entries.emplace(std::string(name), Entry {}).first;
+    }
+
+    Entry& entry = iter->second;
+    ++entry.count;
+    entry.total_us += cost_us;
+    entry.max_us = std::max(entry.max_us, cost_us);
+    ++entry.buckets[bucket];
+}
+
+void asst::PerfStats::reset()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto& entries : m_entries) {
+        entries.clear();
+    }
+    m_reset_time = Clock::now();
+}
+
+json::value asst::PerfStats::to_json() const
+{
+    using namespace std::chrono;
+
+    json::value result = json::object {
+        { "bucket_bounds_ms", json::array(BucketBoundsMs) },
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    result["elapsed_ms"] = duration_cast<milliseconds>(Clock::now() - m_reset_time).count();
+
+    for (size_t i = 0; i < CategoryCount; ++i) {
+        json::object category_json;
+        for (const auto& [name, entry] : m_entries[i]) {
+            category_json.emplace(
+                name,
+                json::object {
+                    { "count", entry.count },
+                    { "total_us", entry.total_us },
+                    { "avg_us", entry.total_us / static_cast<int64_t>(entry.count) },
+                    { "max_us", entry.max_us },
+                    { "buckets", json::array(entry.buckets) },
+                });
+        }
+        result[std::string(category_name(static_cast<Category>(i)))] = std::move(category_json);
+    }
+    return result;
+}
+
+std::string_view asst::PerfStats::category_name(Category category)
+{
+    switch (category) {
+    case Category::Task:
+        return "task";
+    case Category::Pipeline:
+        return "pipeline";
+    case Category::Analyzer:
+        return "analyzer";
+    case Category::Inference:
+        return "inference";
+    case Category::Controller:
+        return "controller";
+    case Category::Sleep:
+        return "sleep";
+    }
+    return "unknown";
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <meojson/json.hpp>
+
+namespace asst
+{
+    // 实例级的耗时统计，按类别和名字累计次数、总耗时、最大耗时和耗时分布
+    // 开销只有一次加锁和一次 map 查找，Release 下也常开
+    class PerfStats
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Category
+        {
+            Task,       // 任务链，按 taskchain 名
+            Pipeline,   // ProcessTask 中各任务的动作执行，按任务名
+            Analyzer,   // 识别器，按类名
+            Inference,  // OCR / ONNX 推理
+            Controller, // 截图、输入等控制器操作
+            Sleep,      // 任务中的主动等待
+        };
+
+        // 分布的桶上界，单位毫秒；最后一个桶收纳更大的值
+        static constexpr std::array<int64_t, 12> BucketBoundsMs = {
+            1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000,
+        };
+
+        struct Entry
+        {
+            uint64_t count = 0;
+            int64_t total_us = 0;
+            int64_t max_us = 0;
+            std::array<uint64_t, BucketBoundsMs.size() + 1> buckets {};
+        };
+
+        // 在作用域结束时记录耗时，stats 为空时什么也不做；name 需在作用域内保持有效
+        class Scope
+        {
+        public:
+            Scope(PerfStats* stats, Category category, std::string_view name) noexcept;
+            Scope(Category category, std::string_view name) noexcept : Scope(current(), category, name) {}
+            Scope(const Scope&) = delete;
+            ~Scope();
+
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            PerfStats* m_stats = nullptr;
+            Category m_category;
+            std::string_view m_name;
+            Clock::time_point m_start;
+        };
+
+        // 把当前线程绑定到某个实例的统计上，识别器等拿不到实例的地方通过 current() 记录
+        class Binding
+        {
+        public:
+            explicit Binding(PerfStats* stats) noexcept;
+            Binding(const Binding&) = delete;
+            ~Binding();
+
+            Binding& operator=(const Binding&) = delete;
+
+        private:
+            PerfStats* m_prev = nullptr;
+        };
+
+    public:
+        PerfStats() = default;
+        PerfStats(const PerfStats&) = delete;
+        PerfStats(PerfStats&&) = delete;
+        ~PerfStats() = default;
+
+        void record(Category category, std::string_view name, Clock::duration cost);
+        void reset();
+        json::value to_json() const;
+
+        static PerfStats* current() noexcept;
+
+        PerfStats& operator=(const PerfStats&) = delete;
+        PerfStats& operator=(PerfStats&&) = delete;
+
+    private:
+        static constexpr size_t CategoryCount = static_cast<size_t>(Category::Sleep) + 1;
+        static std::string_view category_name(Category category);
+
+        mutable std::mutex m_mutex;
+        std::array<std::map<std::string, Entry, std::less<>>, CategoryCount> m_entries;
+        Clock::time_point m_reset_time = Clock::now();
+    };
+}
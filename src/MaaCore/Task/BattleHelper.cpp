@@ -13,6 +13,7 @@
 #include "Utils/Logger.hpp"
 #include "Utils/NoWarningCV.h"
 #include "Utils/Time.hpp"
+#include "Vision/Battle/BattleAvatarMatcher.h"
 #include "Vision/Battle/BattlefieldClassifier.h"
 #include "Vision/Battle/BattlefieldMatcher.h"
 #include "Vision/BestMatcher.h"
@@ -54,6 +55,7 @@ void asst::BattleHelper::clear()
     m_kills = 0;
     m_total_kills = 0;
     m_cur_deployment_opers.clear();
+    m_deployment_cache = {};
     m_battlefield_opers.clear();
     m_used_tiles.clear();
 }
@@ -62,12 +64,13 @@ bool asst::BattleHelper::calc_tiles_info(const std::string& stage_name, double s
 {
     LogTraceFunction;
 
-    if (auto result = Tile.find(stage_name); !result || !json::open(result->second)) {
+    auto level_opt = TilePack::find_level(stage_name);
+    if (!level_opt) {
         return false;
     }
 
-    m_map_data = TilePack::find_level(stage_name).value_or(Map::Level {});
-    auto calc_result = TilePack::calc(stage_name, shift_x, shift_y);
+    m_map_data = std::move(*level_opt);
+    auto calc_result = TilePack::calc(m_map_data, shift_x, shift_y);
     m_normal_tile_info = std::move(calc_result.normal_tile_info);
     m_side_tile_info = std::move(calc_result.side_tile_info);
     m_retreat_button_pos = calc_result.retreat_button;
@@ -110,7 +113,11 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
         auto draw_future = std::async(std::launch::async, [&]() { save_map(image); });
     }
 
+    if (init) {
+        m_deployment_cache = {};
+    }
     BattlefieldMatcher oper_analyzer(image);
+    oper_analyzer.set_deployment_cache(&m_deployment_cache);
 
     // 保全要识别开局费用，先用init判断了，之后别的地方要用的话再做cache
     if (init || need_oper_cost) {
@@ -152,25 +159,31 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
     std::vector<DeploymentOper> unknown_opers;
 
     for (auto& oper : cur_opers) {
-        BestMatcher avatar_analyzer(oper.avatar);
-        avatar_analyzer.set_method(MatchMethod::Ccoeff);
+        auto set_avatar_params = [&](MatcherConfig& analyzer) {
+            analyzer.set_method(MatchMethod::Ccoeff);
+            if (oper.cooling) {
+                static const auto cooling_threshold =
+                    Task.get<MatchTaskInfo>("BattleAvatarCoolingData")->templ_thresholds.front();
+                static const auto cooling_mask_range =
+                    Task.get<MatchTaskInfo>("BattleAvatarCoolingData")->mask_ranges;
+                analyzer.set_threshold(cooling_threshold);
+                analyzer.set_mask_ranges(cooling_mask_range, true, true);
+            }
+            else {
+                static const auto threshold = Task.get<MatchTaskInfo>("BattleAvatarData")->templ_thresholds.front();
+                static const auto drone_threshold =
+                    Task.get<MatchTaskInfo>("BattleDroneAvatarData")->templ_thresholds.front();
+                analyzer.set_threshold(oper.role == Role::Drone ? drone_threshold : threshold);
+            }
+        };
         if (oper.cooling) {
             Log.trace("start matching cooling", oper.index);
-            static const auto cooling_threshold =
-                Task.get<MatchTaskInfo>("BattleAvatarCoolingData")->templ_thresholds.front();
-            static const auto cooling_mask_range = Task.get<MatchTaskInfo>("BattleAvatarCoolingData")->mask_ranges;
-            avatar_analyzer.set_threshold(cooling_threshold);
-            avatar_analyzer.set_mask_ranges(cooling_mask_range, true, true);
-        }
-        else {
-            static const auto threshold = Task.get<MatchTaskInfo>("BattleAvatarData")->templ_thresholds.front();
-            static const auto drone_threshold =
-                Task.get<MatchTaskInfo>("BattleDroneAvatarData")->templ_thresholds.front();
-            avatar_analyzer.set_threshold(oper.role == Role::Drone ? drone_threshold : threshold);
         }
 
         bool is_analyzed = false;
         if (!init) {
+            BestMatcher avatar_analyzer(oper.avatar);
+            set_avatar_params(avatar_analyzer);
             for (const auto& old_oper :
                  old_deployment_opers | views::filter([&](const battle::DeploymentOper& temp_oper) {
                      return temp_oper.role == oper.role;
@@ -184,12 +197,10 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
             }
         }
         if (!is_analyzed) {
-            // 之前的干员都没匹配上，那就把所有的干员都加进去
-            // 可能的优化: 移除之前添加的模板
-            auto& avatar_cache = AvatarCache.get_avatars(oper.role);
-            for (const auto& [name, avatar] : avatar_cache) {
-                avatar_analyzer.append_templ(name, avatar);
-            }
+            // 之前的干员都没匹配上，那就在该职业所有缓存的头像里找
+            BattleAvatarMatcher avatar_analyzer(oper.avatar);
+            set_avatar_params(avatar_analyzer);
+            avatar_analyzer.set_index(AvatarCache.get_index(oper.role));
             if (avatar_analyzer.analyze()) {
                 set_oper_name(oper, avatar_analyzer.get_result().templ_info.name);
                 remove_cooling_from_battlefield(oper);
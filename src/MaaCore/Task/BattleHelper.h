@@ -8,6 +8,7 @@
 #include "Utils/NoWarningCVMat.h"
 #include "Utils/Platform.hpp"
 #include "Utils/WorkingDir.hpp"
+#include "Vision/Battle/BattlefieldMatcher.h"
 
 #include <filesystem>
 #include <map>
@@ -77,8 +78,8 @@ namespace asst
 
         std::string m_stage_name;
         Map::Level m_map_data;
-        std::unordered_map<Point, TilePack::TileInfo> m_side_tile_info;   // 子弹时间的坐标映射
-        std::unordered_map<Point, TilePack::TileInfo> m_normal_tile_info; // 正常的坐标映射
+        TilePack::TileGrid m_side_tile_info;   // 子弹时间的坐标映射
+        TilePack::TileGrid m_normal_tile_info; // 正常的坐标映射
         Point m_skill_button_pos;
         Point m_retreat_button_pos;
         std::unordered_map<std::string, battle::SkillUsage> m_skill_usage;
@@ -95,6 +96,7 @@ namespace asst
         int m_cost = 0;
 
         std::vector<battle::DeploymentOper> m_cur_deployment_opers;
+        BattlefieldMatcher::DeploymentCache m_deployment_cache; // 部署栏增量识别用
 
         std::map<std::string, Point> m_battlefield_opers;
         std::map<Point, std::string> m_used_tiles;
@@ -3,6 +3,7 @@
 #include "Config/Miscellaneous/BattleDataConfig.h"
 #include "Config/Miscellaneous/TilePack.h"
 #include "Config/TaskData.h"
+#include "PerfStats.h"
 #include "Utils/ImageIo.hpp"
 #include "Utils/Logger.hpp"
 #include "Utils/NoWarningCV.h"
@@ -14,6 +15,8 @@
 #include "Vision/BestMatcher.h"
 #include "Vision/RegionOCRer.h"
 
+#include <future>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -31,13 +34,7 @@ bool asst::CombatRecordRecognitionTask::_run()
 {
     LogTraceFunction;
 
-    auto release_video = [](cv::VideoCapture* video) {
-        if (video && video->isOpened()) {
-            video->release();
-        }
-    };
-    auto crt_path = utils::path_to_crt_string(m_video_path);
-    m_video_ptr = std::shared_ptr<cv::VideoCapture>(new cv::VideoCapture(crt_path), release_video);
+    m_video_ptr = open_video();
 
     if (!m_video_ptr->isOpened()) {
         Log.error(__FUNCTION__, "video_io open failed", m_video_path);
@@ -268,6 +265,7 @@ bool asst::CombatRecordRecognitionTask::analyze_deployment()
     for (const auto& [name, formation_avatar] : m_formation) {
         BestMatcher best_match_analyzer(formation_avatar);
         best_match_analyzer.set_task_info(avatar_task_ptr);
+        best_match_analyzer.set_parallel(true);
 
         std::unordered_set<battle::Role> roles = { BattleData.get_role(name) };
         if (name == "阿米娅") {
@@ -316,18 +314,56 @@ bool asst::CombatRecordRecognitionTask::slice_video()
 
     const int skip_count = m_video_fps > m_deployment_fps ? static_cast<int>(m_video_fps / m_deployment_fps) - 1 : 0;
 
+    const size_t step = static_cast<size_t>(skip_count) + 1;
+    const size_t begin = m_battle_start_frame;
+    const size_t ends = m_video_frame_count - skip_count - 10;
+
+    /* 并行识别：按帧分块，每块一个独立的 VideoCapture */
+    const size_t total = ends > begin ? (ends - begin + step - 1) / step : 0;
+    std::vector<std::optional<SliceFrame>> frames(total);
+    {
+        const size_t max_chunk_count = (std::max)(std::thread::hardware_concurrency(), 1U);
+        const size_t chunk_count = std::clamp<size_t>(total / MinSliceChunkFrames, 1, max_chunk_count);
+        const size_t chunk_size = (total + chunk_count - 1) / chunk_count;
+        Log.info(__FUNCTION__, "frames:", total, "chunks:", chunk_count);
+
+#ifdef ASST_DEBUG
+        // show_img 里的 imshow 只能在当前线程调用，调试时各块推迟到 wait 时依次执行
+        constexpr auto LaunchPolicy = std::launch::deferred;
+#else
+        constexpr auto LaunchPolicy = std::launch::async;
+#endif
+        // 识别器通过 PerfStats::current() 记录耗时，工作线程也要绑定到本实例
+        PerfStats* perf_stats = PerfStats::current();
+        std::vector<std::future<void>> futures;
+        for (size_t first = 0; first < total; first += chunk_size) {
+            const size_t last = (std::min)(first + chunk_size, total);
+            futures.emplace_back(std::async(LaunchPolicy, [&, perf_stats, first, last]() {
+                PerfStats::Binding binding(perf_stats);
+                analyze_slice_frames(frames, first, last, begin, step);
+            }));
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+    }
+    if (need_exit()) {
+        return false;
+    }
+
+    /* 按顺序合并，逻辑与逐帧顺序识别一致；需要用到的原图再按需读出来 */
+    const Rect avatar_move = Task.get("BattleOperAvatar")->rect_move;
+
     int not_in_battle_count = 0;
     bool in_segment = false;
 
-    cv::Mat frame;
-    cv::Mat pre_frame;
-
-    size_t i = m_battle_start_frame;
-    size_t ends = m_video_frame_count - skip_count - 10;
+    size_t i = begin;
 
     int latest_kills = -1;
     int total_kills = -1;
 
+    // 上一个识别的帧
+    auto read_pre_frame = [&]() { return i >= begin + step ? read_frame(i - step) : cv::Mat(); };
     auto battle_over = [&]() {
         if (m_clips.empty()) {
             return;
@@ -340,31 +376,32 @@ bool asst::CombatRecordRecognitionTask::slice_video()
         }
         auto& pre_clip = m_clips.back();
         pre_clip.end_frame_index = i - skip_count;
-        pre_clip.end_frame = pre_frame;
+        pre_clip.end_frame = read_pre_frame();
         in_segment = false;
     };
-    for (; i < ends; i += skip_frames(skip_count) + 1, pre_frame = frame) {
-        cv::Mat temp;
-        // 这里如果不用temp，frame的所有权会出错
-        *m_video_ptr >> temp;
-        frame = temp;
-        if (frame.empty()) {
+    for (; i < ends; i += step) {
+        if (need_exit()) {
+            return false;
+        }
+        auto& frame_opt = frames[(i - begin) / step];
+        if (!frame_opt) {
+            // 所在分块打开视频失败，在这里补上（取消导致的空缺在上面已经返回了）
+            cv::Mat frame = read_frame(i);
+            frame_opt = frame.empty() ? SliceFrame { .empty = true }
+                                      : SliceFrame { .total_kills_prompt = total_kills,
+                                                     .result = analyze_slice_frame(frame, total_kills) };
+        }
+        if (frame_opt->empty) {
             Log.warn(i, "frame is empty");
             battle_over();
             break;
         }
-        cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
-
-        BattlefieldMatcher analyzer(frame);
-        analyzer.set_object_of_interest({
-            .deployment = true,
-            .kills = true,
-            .speed_button = true,
-        });
-
-        analyzer.set_total_kills_prompt(total_kills);
-        auto result_opt = analyzer.analyze();
-        show_img(analyzer);
+        if (frame_opt->total_kills_prompt != total_kills) {
+            // 分块开头的几帧不知道前面的总击杀数，按顺序识别时的提示重新识别一次
+            frame_opt->total_kills_prompt = total_kills;
+            frame_opt->result = analyze_slice_frame(read_frame(i), total_kills);
+        }
+        auto& result_opt = frame_opt->result;
 
         if (!result_opt) {
             battle_over();
@@ -385,7 +422,7 @@ bool asst::CombatRecordRecognitionTask::slice_video()
             total_kills = cur_total_kills;
         }
 
-        const auto& cur_opers = result_opt->deployment;
+        auto& cur_opers = result_opt->deployment;
         bool continuity = true;
         int pre_distance = 0;
         for (auto iter = cur_opers.begin(); iter != cur_opers.end(); ++iter) {
@@ -409,13 +446,13 @@ bool asst::CombatRecordRecognitionTask::slice_video()
             }
             auto& pre_clip = m_clips.back();
             if (pre_clip.ends_oper_name.empty()) {
-                pre_clip.ends_oper_name = analyze_detail_page_oper_name(frame);
+                pre_clip.ends_oper_name = analyze_detail_page_oper_name(read_frame(i));
             }
             if (!in_segment) {
                 continue;
             }
             pre_clip.end_frame_index = i - skip_count;
-            pre_clip.end_frame = pre_frame;
+            pre_clip.end_frame = read_pre_frame();
             in_segment = false;
 
             continue;
@@ -425,6 +462,12 @@ bool asst::CombatRecordRecognitionTask::slice_video()
             continue;
         }
         else if (!in_segment) {
+            cv::Mat frame = read_frame(i);
+            for (auto& oper : cur_opers) {
+                Rect avatar_rect = oper.rect.move(avatar_move);
+                oper.avatar = frame(make_rect<cv::Rect>(avatar_rect));
+            }
+
             ClipInfo info;
             info.start_frame_index = i; // 后处理会加个 offset
             info.end_frame_index = i;
@@ -509,7 +552,8 @@ bool asst::CombatRecordRecognitionTask::compare_skill(ClipInfo& clip, ClipInfo&
 
     const std::string oper_name = pre_clip.ends_oper_name;
     const Point target_location = m_operator_locations[oper_name];
-    const Point target_position = m_normal_tile_info[target_location].pos;
+    auto target_iter = m_normal_tile_info.find(target_location);
+    const Point target_position = target_iter == m_normal_tile_info.end() ? Point() : target_iter->second.pos;
     BattlefieldClassifier analyzer(pre_clip.end_frame);
     analyzer.set_object_of_interest({ .skill_ready = true });
     analyzer.set_base_point(target_position);
@@ -529,8 +573,7 @@ bool asst::CombatRecordRecognitionTask::compare_skill(ClipInfo& clip, ClipInfo&
         Log.warn("skip too much");
         cls_begin = clip.start_frame_index + (clip.end_frame_index - clip.start_frame_index) / 2;
     }
-    const size_t begin_skip = cls_begin - static_cast<size_t>(m_video_ptr->get(cv::CAP_PROP_POS_FRAMES));
-    skip_frames(begin_skip);
+    seek_frame(*m_video_ptr, cls_begin);
 
     cv::Mat frame;
     *m_video_ptr >> frame;
@@ -579,8 +622,7 @@ bool asst::CombatRecordRecognitionTask::detect_operators(ClipInfo& clip, [[maybe
     const size_t det_begin = clip.start_frame_index + skip_count;
     const size_t det_end = clip.end_frame_index - skip_count;
 
-    const size_t begin_skip = det_begin - static_cast<size_t>(m_video_ptr->get(cv::CAP_PROP_POS_FRAMES));
-    skip_frames(begin_skip);
+    seek_frame(*m_video_ptr, det_begin);
 
     for (size_t i = det_begin; i <= det_end; i += skip_frames(skip_count) + 1) {
         cv::Mat frame;
@@ -657,16 +699,25 @@ bool asst::CombatRecordRecognitionTask::classify_direction(ClipInfo& clip, ClipI
     constexpr size_t ClsSize = BattlefieldClassifier::DeployDirectionResult::ClsSize;
     std::unordered_map<Point, Raw> dir_cls_sampling;
 
+    // 整个片段所有采样帧、所有新干员一起送进模型
+    std::vector<BattlefieldClassifier::DeployDirectionQuery> queries;
+    std::vector<Point> query_locs;
+    queries.reserve(clip.random_frames.size() * newcomer.size());
+    query_locs.reserve(queries.capacity());
     for (const cv::Mat& frame : clip.random_frames) {
-        BattlefieldClassifier analyzer(frame);
-        analyzer.set_object_of_interest({ .skill_ready = false, .deploy_direction = true });
         for (const auto& loc : newcomer) {
-            analyzer.set_base_point(m_normal_tile_info.at(loc).pos);
-            auto result_opt = analyzer.analyze();
-            show_img(analyzer);
-            for (size_t i = 0; i < ClsSize; ++i) {
-                dir_cls_sampling[loc][i] += result_opt->deploy_direction.raw[i];
-            }
+            queries.emplace_back(BattlefieldClassifier::DeployDirectionQuery {
+                .image = frame,
+                .base_point = m_normal_tile_info.at(loc).pos,
+            });
+            query_locs.emplace_back(loc);
+        }
+    }
+
+    auto results = BattlefieldClassifier::deploy_direction_analyze_batch(queries);
+    for (size_t i = 0; i < results.size(); ++i) {
+        for (size_t j = 0; j < ClsSize; ++j) {
+            dir_cls_sampling[query_locs[i]][j] += results[i].raw[j];
         }
     }
 
@@ -785,6 +836,7 @@ void asst::CombatRecordRecognitionTask::ananlyze_deployment_names(ClipInfo& clip
         static const double threshold = Task.get<MatchTaskInfo>("BattleAvatarDataForVideo")->templ_thresholds.front();
         avatar_analyzer.set_method(MatchMethod::Ccoeff);
         avatar_analyzer.set_threshold(threshold);
+        avatar_analyzer.set_parallel(true);
         // static const double drone_threshold = Task.get<MatchTaskInfo>("BattleDroneAvatarData")->templ_threshold;
         // avatar_analyzer.set_threshold(oper.role == battle::Role::Drone ? drone_threshold : threshold);
 
@@ -856,13 +908,109 @@ json::object asst::CombatRecordRecognitionTask::analyze_action_condition(ClipInf
 
 size_t asst::CombatRecordRecognitionTask::skip_frames(size_t count)
 {
+    // 只 grab 不 retrieve，省掉解码后的颜色转换和拷贝
     for (size_t i = 0; i < count; ++i) {
-        cv::Mat ignore;
-        *m_video_ptr >> ignore;
+        m_video_ptr->grab();
     }
     return count;
 }
 
+void asst::CombatRecordRecognitionTask::analyze_slice_frames(std::vector<std::optional<SliceFrame>>& frames,
+                                                             size_t first, size_t last, size_t begin, size_t step)
+{
+    auto video_ptr = open_video();
+    if (!video_ptr->isOpened()) {
+        Log.error(__FUNCTION__, "video_io open failed", m_video_path);
+        return;
+    }
+    seek_frame(*video_ptr, begin + first * step);
+
+    int total_kills = -1;
+    for (size_t k = first; k < last && !need_exit(); ++k) {
+        cv::Mat frame;
+        *video_ptr >> frame;
+        if (frame.empty()) {
+            frames[k] = SliceFrame { .empty = true };
+            break;
+        }
+        cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
+
+        auto result_opt = analyze_slice_frame(frame, total_kills);
+        const int prompt = total_kills;
+        if (result_opt && result_opt->kills) {
+            total_kills = result_opt->kills->second;
+        }
+        frames[k] = SliceFrame { .total_kills_prompt = prompt, .result = std::move(result_opt) };
+
+        for (size_t j = 1; j < step; ++j) {
+            video_ptr->grab();
+        }
+    }
+}
+
+asst::BattlefieldMatcher::ResultOpt asst::CombatRecordRecognitionTask::analyze_slice_frame(const cv::Mat& frame,
+                                                                                            int total_kills_prompt)
+{
+    BattlefieldMatcher analyzer(frame);
+    analyzer.set_object_of_interest({
+        .deployment = true,
+        .kills = true,
+        .speed_button = true,
+    });
+    analyzer.set_total_kills_prompt(total_kills_prompt);
+
+    auto result_opt = analyzer.analyze();
+    show_img(analyzer);
+    if (result_opt) {
+        // 头像是原帧的 ROI，留着会让整帧都释放不掉，用到的时候再从原帧里取
+        for (auto& oper : result_opt->deployment) {
+            oper.avatar = cv::Mat();
+        }
+    }
+    return result_opt;
+}
+
+std::shared_ptr<cv::VideoCapture> asst::CombatRecordRecognitionTask::open_video() const
+{
+    auto release_video = [](cv::VideoCapture* video) {
+        if (video && video->isOpened()) {
+            video->release();
+        }
+        delete video;
+    };
+    auto crt_path = utils::path_to_crt_string(m_video_path);
+    return std::shared_ptr<cv::VideoCapture>(new cv::VideoCapture(crt_path), release_video);
+}
+
+void asst::CombatRecordRecognitionTask::seek_frame(cv::VideoCapture& video, size_t index) const
+{
+    const auto pos = static_cast<size_t>(video.get(cv::CAP_PROP_POS_FRAMES));
+    if (index == pos) {
+        return;
+    }
+    // 往回走或者离得太远就直接 seek（解码器会从前一个关键帧解到目标帧），否则逐帧 grab
+    const auto seek_threshold = static_cast<size_t>(m_video_fps * KeyframeSeekSeconds);
+    if (index < pos || index - pos > seek_threshold) {
+        video.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index));
+        return;
+    }
+    for (size_t i = pos; i < index; ++i) {
+        video.grab();
+    }
+}
+
+cv::Mat asst::CombatRecordRecognitionTask::read_frame(size_t index)
+{
+    seek_frame(*m_video_ptr, index);
+
+    cv::Mat frame;
+    *m_video_ptr >> frame;
+    if (!frame.empty()) {
+        cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
+    }
+    return frame;
+}
+
 std::string asst::CombatRecordRecognitionTask::analyze_detail_page_oper_name(const cv::Mat& frame)
 {
     const auto& replace_task = Task.get<OcrTaskInfo>("CharsNameOcrReplace");
@@ -5,6 +5,7 @@
 #include "Common/AsstBattleDef.h"
 #include "Common/AsstTypes.h"
 #include "Config/Miscellaneous/TilePack.h"
+#include "Vision/Battle/BattlefieldMatcher.h"
 
 #include <meojson/json.hpp>
 
@@ -49,6 +50,14 @@ namespace asst
             std::string ends_oper_name;
         };
 
+        // slice_video 中单帧的识别结果
+        struct SliceFrame
+        {
+            bool empty = false;          // 读帧失败
+            int total_kills_prompt = -1; // 识别时使用的 total_kills_prompt，与顺序识别时的不同则需要重新识别
+            BattlefieldMatcher::ResultOpt result;
+        };
+
         bool analyze_formation();
         bool analyze_stage();
         bool analyze_deployment();
@@ -64,6 +73,15 @@ namespace asst
         json::object analyze_action_condition(ClipInfo& clip, ClipInfo* pre_clip_ptr);
         size_t skip_frames(size_t count);
 
+        // 每个线程打开一个独立的 VideoCapture，从 begin 开始每隔 step 帧识别一帧，结果写入 frames[first, last)
+        void analyze_slice_frames(std::vector<std::optional<SliceFrame>>& frames, size_t first, size_t last,
+                                  size_t begin, size_t step);
+        BattlefieldMatcher::ResultOpt analyze_slice_frame(const cv::Mat& frame, int total_kills_prompt);
+
+        std::shared_ptr<cv::VideoCapture> open_video() const;
+        void seek_frame(cv::VideoCapture& video, size_t index) const;
+        cv::Mat read_frame(size_t index);
+
         static std::string analyze_detail_page_oper_name(const cv::Mat& frame);
 
         std::filesystem::path m_video_path;
@@ -77,6 +95,11 @@ namespace asst
         int m_stage_ocr_fps = 2;
         int m_deployment_fps = 5;
 
+        // seek 距离超过这么多秒时直接跳到关键帧解码，否则逐帧 grab
+        static constexpr double KeyframeSeekSeconds = 2.0;
+        // 每个分析线程至少处理这么多帧，太碎的话 seek 的开销比识别还大
+        static constexpr size_t MinSliceChunkFrames = 32;
+
         size_t m_formation_end_frame = 0;
         size_t m_stage_ocr_end_frame = 0;
         size_t m_battle_start_frame = 0;
@@ -85,7 +108,7 @@ namespace asst
         std::vector<ClipInfo> m_clips;
         std::vector<std::pair<size_t /*frame*/, int /*kills*/>> m_frame_kills;
 
-        std::unordered_map<Point, TilePack::TileInfo> m_normal_tile_info;
+        TilePack::TileGrid m_normal_tile_info;
         std::unordered_map<std::string, cv::Mat> m_formation;
         std::unordered_map<std::string, cv::Mat> m_all_avatars;
 
@@ -2,6 +2,7 @@
 
 #include "Utils/Ranges.hpp"
 #include <algorithm>
+#include <numeric>
 
 #include <calculator/calculator.hpp>
 
@@ -368,22 +369,40 @@ bool asst::InfrastProductionTask::optimal_calc()
     }
 
     std::vector<infrast::SkillsComb> all_available_combs;
+    std::vector<PerceptualHash> all_available_hashes;
     all_available_combs.reserve(m_all_available_opers.size());
+    all_available_hashes.reserve(m_all_available_opers.size());
     for (auto&& oper : m_all_available_opers) {
         auto comb = efficient_regex_calc(oper.skills);
         comb.name_img = oper.name_img;
         all_available_combs.emplace_back(std::move(comb));
+        all_available_hashes.emplace_back(oper.face_hash);
     }
 
-    // 先把单个的技能按效率排个序，取效率最高的几个
-    std::vector<infrast::SkillsComb> optimal_combs;
-    optimal_combs.reserve(cur_max_num_of_opers);
-    double max_efficient = 0;
-    ranges::sort(all_available_combs, [&](const infrast::SkillsComb& lhs, const infrast::SkillsComb& rhs) -> bool {
-        return lhs.efficient.at(m_product) > rhs.efficient.at(m_product);
-    });
-
+    // 先把单个的技能按效率排个序
+    {
+        std::vector<size_t> order(all_available_combs.size());
+        std::iota(order.begin(), order.end(), 0);
+        ranges::stable_sort(order, [&](size_t lhs, size_t rhs) -> bool {
+            return all_available_combs[lhs].efficient.at(m_product) > all_available_combs[rhs].efficient.at(m_product);
+        });
+        std::vector<infrast::SkillsComb> sorted_combs;
+        std::vector<PerceptualHash> sorted_hashes;
+        sorted_combs.reserve(order.size());
+        sorted_hashes.reserve(order.size());
+        for (size_t index : order) {
+            sorted_combs.emplace_back(std::move(all_available_combs[index]));
+            sorted_hashes.emplace_back(all_available_hashes[index]);
+        }
+        all_available_combs = std::move(sorted_combs);
+        all_available_hashes = std::move(sorted_hashes);
+    }
+    // 效率向量，后面的计算都只看这个，不再反复查 map
+    std::vector<double> all_available_efficient;
+    all_available_efficient.reserve(all_available_combs.size());
     for (const auto& comb : all_available_combs) {
+        all_available_efficient.emplace_back(comb.efficient.at(m_product));
+
         std::string skill_str;
         for (const auto& skill : comb.skills) {
             skill_str += skill.id + " ";
@@ -391,31 +410,55 @@ bool asst::InfrastProductionTask::optimal_calc()
         Log.trace(skill_str, comb.efficient.at(m_product));
     }
 
-    std::unordered_map<std::string, int> skills_num;
-    for (size_t i = 0; i != m_all_available_opers.size(); ++i) {
-        const auto& comb = all_available_combs.at(i);
-
-        bool out_of_num = false;
-        for (auto&& skill : comb.skills) {
-            if (skills_num[skill.id] >= skill.max_num) {
-                out_of_num = true;
+    // 条件判断，不符合的技能组直接过滤掉
+    auto& all_group = InfrastData.get_skills_group(facility_name());
+    std::vector<bool> group_meet_condition(all_group.size(), true);
+    for (size_t group_index = 0; group_index < all_group.size(); ++group_index) {
+        for (const auto& [cond, cond_value] : all_group[group_index].conditions) {
+            auto cond_opt = status()->get_number(cond);
+            if (!cond_opt) {
+                continue;
+            }
+            // TODO：这里做成除了不等于，还可计算大于、小于等不同条件的
+            int cur_value = static_cast<int>(cond_opt.value());
+            if (cur_value != cond_value) {
+                group_meet_condition[group_index] = false;
                 break;
             }
         }
-        if (out_of_num) {
-            continue;
-        }
-
-        optimal_combs.emplace_back(comb);
-        max_efficient += all_available_combs.at(i).efficient.at(m_product);
+    }
 
-        for (auto&& skill : comb.skills) {
-            ++skills_num[skill.id];
+    // 同样的干员、效率和条件，结果一定相同（例如选择失败后重新识别），直接复用
+    std::string cache_key = facility_name() + "|" + m_product + "|" + std::to_string(cur_max_num_of_opers) + "|";
+    for (bool meet : group_meet_condition) {
+        cache_key += meet ? '1' : '0';
+    }
+    for (size_t i = 0; i < all_available_combs.size(); ++i) {
+        std::vector<std::string> skill_ids;
+        for (const auto& skill : all_available_combs[i].skills) {
+            skill_ids.emplace_back(skill.id);
         }
-
-        if (optimal_combs.size() >= static_cast<size_t>(cur_max_num_of_opers)) {
-            break;
+        ranges::sort(skill_ids);
+        cache_key += "|";
+        for (const auto& id : skill_ids) {
+            cache_key += id + ",";
         }
+        cache_key += std::to_string(all_available_efficient[i]) + "," + Hasher::to_string(all_available_hashes[i]);
+    }
+    if (auto cache_iter = m_optimal_combs_cache.find(cache_key); cache_iter != m_optimal_combs_cache.cend()) {
+        Log.trace("optimal combs cache hit");
+        m_optimal_combs = cache_iter->second;
+        return true;
+    }
+
+    // 在技能数量上限的约束下，用分支定界找出效率之和最高的单干员组合
+    std::vector<infrast::SkillsComb> optimal_combs;
+    optimal_combs.reserve(cur_max_num_of_opers);
+    double max_efficient = 0;
+    for (size_t index :
+         best_single_combs(all_available_combs, all_available_efficient, static_cast<size_t>(cur_max_num_of_opers))) {
+        optimal_combs.emplace_back(all_available_combs[index]);
+        max_efficient += all_available_efficient[index];
     }
 
     {
@@ -431,42 +474,55 @@ bool asst::InfrastProductionTask::optimal_calc()
     // 需要选的人和当前房间最大人数不想等，组合就不启用。
     // 可能是房间等级没升满，或者是自定义配置提前选了几个人等
     if (cur_max_num_of_opers != facility_info.max_num_of_opers) {
+        cache_optimal_combs(std::move(cache_key), optimal_combs);
         m_optimal_combs = std::move(optimal_combs);
         return true;
     }
 
+    // 名字 OCR 比较慢，同一个干员在不同技能组里只识别一次
+    std::unordered_map<size_t, std::optional<std::string>> name_cache;
+    auto get_oper_name = [&](size_t index) -> const std::optional<std::string>& {
+        if (auto iter = name_cache.find(index); iter != name_cache.cend()) {
+            return iter->second;
+        }
+        RegionOCRer name_analyzer(all_available_combs[index].name_img);
+        name_analyzer.set_replace(
+            Task.get<OcrTaskInfo>("CharsNameOcrReplace")->replace_map,
+            Task.get<OcrTaskInfo>("CharsNameOcrReplace")->replace_full);
+        Log.trace("Analyze name filter");
+        std::optional<std::string> name;
+        if (name_analyzer.analyze()) {
+            name = name_analyzer.get_result().text;
+        }
+        return name_cache.emplace(index, std::move(name)).first->second;
+    };
+
     // 遍历所有组合，找到效率最高的
-    auto& all_group = InfrastData.get_skills_group(facility_name());
-    for (const infrast::SkillsGroup& group : all_group) {
+    // 只记录哪些干员被用掉了，不再为每个技能组复制一份所有干员
+    std::vector<bool> used(all_available_combs.size(), false);
+    for (size_t group_index = 0; group_index < all_group.size(); ++group_index) {
+        const infrast::SkillsGroup& group = all_group[group_index];
         Log.trace(group.desc);
-        auto cur_available_opers = all_available_combs;
+        if (!group_meet_condition[group_index]) {
+            continue;
+        }
+        ranges::fill(used, false);
         bool group_unavailable = false;
         std::vector<infrast::SkillsComb> cur_combs;
         cur_combs.reserve(cur_max_num_of_opers);
         double cur_efficient = 0;
-        // 条件判断，不符合的直接过滤掉
-        bool meet_condition = true;
-        for (const auto& [cond, cond_value] : group.conditions) {
-            auto cond_opt = status()->get_number(cond);
-            if (!cond_opt) {
-                continue;
-            }
-            // TODO：这里做成除了不等于，还可计算大于、小于等不同条件的
-            int cur_value = static_cast<int>(cond_opt.value());
-            if (cur_value != cond_value) {
-                meet_condition = false;
-                break;
-            }
-        }
-        if (!meet_condition) {
-            continue;
-        }
+
         // necessary里的技能，一个都不能少
         // TODO necessary暂时没做hash校验。因为没有需要比hash的necessary干员（
         for (const infrast::SkillsComb& nec_skills : group.necessary) {
-            auto find_iter = ranges::find_if(cur_available_opers,
-                                             [&](const infrast::SkillsComb& arg) -> bool { return arg == nec_skills; });
-            if (find_iter == cur_available_opers.cend()) {
+            size_t found = all_available_combs.size();
+            for (size_t i = 0; i < all_available_combs.size(); ++i) {
+                if (!used[i] && all_available_combs[i] == nec_skills) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found == all_available_combs.size()) {
                 group_unavailable = true;
                 break;
             }
@@ -477,7 +533,7 @@ bool asst::InfrastProductionTask::optimal_calc()
             else {
                 cur_efficient += nec_skills.efficient.at(m_product);
             }
-            cur_available_opers.erase(find_iter);
+            used[found] = true;
         }
         if (group_unavailable) {
             continue;
@@ -496,56 +552,43 @@ bool asst::InfrastProductionTask::optimal_calc()
 
         // 可能有多个干员有同样的技能，所以这里需要循环找同一个技能，直到找不到为止
         for (const infrast::SkillsComb& opt : optional) {
-            auto find_iter = cur_available_opers.cbegin();
-            while (cur_combs.size() != static_cast<size_t>(cur_max_num_of_opers)) {
-                find_iter = std::find_if(find_iter, cur_available_opers.cend(),
-                                         [&](const infrast::SkillsComb& arg) -> bool { return arg == opt; });
-                if (find_iter != cur_available_opers.cend()) {
-                    bool hash_matched = false;
-                    if (opt.name_filter.empty()) {
-                        hash_matched = true;
-                    }
-                    else {
-                        RegionOCRer name_analyzer(find_iter->name_img);
-                        name_analyzer.set_replace(Task.get<OcrTaskInfo>("CharsNameOcrReplace")->replace_map,
-                                                  Task.get<OcrTaskInfo>("CharsNameOcrReplace")->replace_full);
-                        Log.trace("Analyze name filter");
-                        if (name_analyzer.analyze()) {
-                            std::string name = name_analyzer.get_result().text;
-                            hash_matched =
-                                ranges::find(opt.name_filter, name) != opt.name_filter.cend();
-                        }
-                        else {
-                            hash_matched = false;
-                        }
-                    }
-                    if (!hash_matched) {
-                        ++find_iter;
+            for (size_t i = 0; i < all_available_combs.size(); ++i) {
+                if (cur_combs.size() == static_cast<size_t>(cur_max_num_of_opers)) {
+                    break;
+                }
+                if (used[i] || !(all_available_combs[i] == opt)) {
+                    continue;
+                }
+                if (!opt.name_filter.empty()) {
+                    const auto& name = get_oper_name(i);
+                    if (!name || ranges::find(opt.name_filter, *name) == opt.name_filter.cend()) {
                         continue;
                     }
-
-                    cur_combs.emplace_back(opt);
-                    cur_efficient += opt.efficient.at(m_product);
-                    find_iter = cur_available_opers.erase(find_iter);
-                }
-                else {
-                    break;
                 }
+                cur_combs.emplace_back(opt);
+                cur_efficient += opt.efficient.at(m_product);
+                used[i] = true;
             }
         }
 
         // 说明可选的没凑满人
         if (cur_combs.size() < static_cast<size_t>(cur_max_num_of_opers)) {
             // 允许外部的话，就把单个干员凑进来
-            if (group.allow_external) {
-                size_t substitutes = cur_max_num_of_opers - cur_combs.size();
-                for (size_t index = 0; index < substitutes; ++index) {
-                    const auto& comb = cur_available_opers.at(index);
-                    cur_combs.emplace_back(comb);
-                    cur_efficient += comb.efficient.at(m_product);
+            if (!group.allow_external) { // 否则这个组合人不够，就不可用了
+                continue;
+            }
+            for (size_t i = 0; i < all_available_combs.size(); ++i) {
+                if (cur_combs.size() == static_cast<size_t>(cur_max_num_of_opers)) {
+                    break;
+                }
+                if (used[i]) {
+                    continue;
                 }
+                cur_combs.emplace_back(all_available_combs[i]);
+                cur_efficient += all_available_efficient[i];
+                used[i] = true;
             }
-            else { // 否则这个组合人不够，就不可用了
+            if (cur_combs.size() < static_cast<size_t>(cur_max_num_of_opers)) {
                 continue;
             }
         }
@@ -574,11 +617,112 @@ bool asst::InfrastProductionTask::optimal_calc()
         Log.trace("optimal efficient", max_efficient, " , skills:", log_str);
     }
 
+    cache_optimal_combs(std::move(cache_key), optimal_combs);
     m_optimal_combs = std::move(optimal_combs);
 
     return true;
 }
 
+void asst::InfrastProductionTask::cache_optimal_combs(std::string key, const std::vector<infrast::SkillsComb>& combs)
+{
+    if (m_optimal_combs_cache.size() >= OptimalCombsCacheSize && !m_optimal_combs_cache.contains(key)) {
+        m_optimal_combs_cache.clear();
+    }
+    m_optimal_combs_cache.insert_or_assign(std::move(key), combs);
+}
+
+std::vector<size_t> asst::InfrastProductionTask::best_single_combs(
+    const std::vector<infrast::SkillsComb>& combs,
+    const std::vector<double>& efficient,
+    size_t max_num_of_opers)
+{
+    // 搜索节点数的上限，防止极端情况下耗时过长，超出后返回当前找到的最优解
+    static constexpr size_t MaxSearchNodes = 100000;
+
+    const size_t size = combs.size();
+    // efficient 已降序排列，prefix[i + n] - prefix[i] 即从 i 开始再选 n 个人的效率上界
+    std::vector<double> prefix(size + 1, 0);
+    for (size_t i = 0; i < size; ++i) {
+        prefix[i + 1] = prefix[i] + efficient[i];
+    }
+
+    std::vector<size_t> best;
+    double best_efficient = -1;
+    std::vector<size_t> cur;
+    cur.reserve(max_num_of_opers);
+    double cur_efficient = 0;
+    std::unordered_map<std::string, int> skills_num;
+    size_t search_nodes = 0;
+
+    auto search = [&](auto& self, size_t start) -> void {
+        ++search_nodes;
+        // 严格大于，效率相同时保留先找到的，也就是与贪心结果一致的那个
+        if (cur_efficient > best_efficient) {
+            best = cur;
+            best_efficient = cur_efficient;
+        }
+        if (cur.size() >= max_num_of_opers || search_nodes > MaxSearchNodes) {
+            return;
+        }
+        const size_t remain = max_num_of_opers - cur.size();
+        for (size_t i = start; i < size; ++i) {
+            if (cur_efficient + prefix[(std::min)(size, i + remain)] - prefix[i] <= best_efficient) {
+                break; // 后面的只会更小
+            }
+            const auto& skills = combs[i].skills;
+            if (ranges::any_of(skills, [&](const infrast::Skill& skill) {
+                    return skills_num[skill.id] >= skill.max_num;
+                })) {
+                continue;
+            }
+            for (const auto& skill : skills) {
+                ++skills_num[skill.id];
+            }
+            cur.emplace_back(i);
+            cur_efficient += efficient[i];
+
+            self(self, i + 1);
+
+            cur_efficient -= efficient[i];
+            cur.pop_back();
+            for (const auto& skill : skills) {
+                --skills_num[skill.id];
+            }
+        }
+    };
+    search(search, 0);
+
+    if (search_nodes > MaxSearchNodes) {
+        Log.warn(__FUNCTION__, "search nodes exceeded, result may be suboptimal");
+    }
+
+    // 效率为 0 的干员不会让结果变好，搜索时会被剪掉，这里和原来的贪心一样按顺序把空位补满
+    if (best.size() < max_num_of_opers) {
+        skills_num.clear();
+        std::vector<bool> chosen(size, false);
+        for (size_t index : best) {
+            chosen[index] = true;
+            for (const auto& skill : combs[index].skills) {
+                ++skills_num[skill.id];
+            }
+        }
+        for (size_t i = 0; i < size && best.size() < max_num_of_opers; ++i) {
+            const auto& skills = combs[i].skills;
+            if (chosen[i] || ranges::any_of(skills, [&](const infrast::Skill& skill) {
+                    return skills_num[skill.id] >= skill.max_num;
+                })) {
+                continue;
+            }
+            for (const auto& skill : skills) {
+                ++skills_num[skill.id];
+            }
+            best.emplace_back(i);
+        }
+        ranges::sort(best);
+    }
+    return best;
+}
+
 bool asst::InfrastProductionTask::opers_choose()
 {
     LogTraceFunction;
@@ -30,12 +30,21 @@ namespace asst
         void set_product(std::string product_name) noexcept;
 
         infrast::SkillsComb efficient_regex_calc(std::unordered_set<infrast::Skill> skills) const;
+        // 返回 combs 中被选中的下标，combs 与 efficient 需按效率降序排列
+        static std::vector<size_t> best_single_combs(
+            const std::vector<infrast::SkillsComb>& combs,
+            const std::vector<double>& efficient,
+            size_t max_num_of_opers);
+        void cache_optimal_combs(std::string key, const std::vector<infrast::SkillsComb>& combs);
 
         std::string m_product;
         std::string m_uses_of_drones;
         int m_cur_num_of_locked_opers = 0;
         std::vector<infrast::Oper> m_all_available_opers;
         std::vector<infrast::SkillsComb> m_optimal_combs;
+        // key: 设施、产物、技能组条件与所有可用干员的技能/效率/hash
+        std::unordered_map<std::string, std::vector<infrast::SkillsComb>> m_optimal_combs_cache;
+        static constexpr size_t OptimalCombsCacheSize = 16; // 超出后整个清空，只为复用最近几次的计算结果
         std::vector<Rect> m_facility_list_tabs;
         size_t max_num_of_opers_per_page = 0;
         bool m_is_use_custom_drones = false;
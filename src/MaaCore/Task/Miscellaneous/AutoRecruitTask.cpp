@@ -21,101 +21,98 @@ namespace asst::recruit_calc
 // no senior tag
 auto get_all_combs(
     const std::vector<RecruitConfig::TagId>& tags,
-    const std::vector<Recruitment>& all_ops = RecruitData.get_all_opers())
+    const RecruitConfig& recruit_config = RecruitData)
 {
-    std::vector<RecruitCombs> rcs_with_single_tag;
-
-    {
-        rcs_with_single_tag.reserve(tags.size());
-        ranges::transform(
-            tags,
-            std::back_inserter(rcs_with_single_tag),
-            [](const RecruitConfig::TagId& t) {
-                RecruitCombs result;
-                result.tags = { t };
-                result.min_level = 6;
-                result.max_level = 0;
-                result.avg_level = 0;
-                return result;
-            });
+    using OperMask = RecruitConfig::OperMask;
+    static constexpr std::string_view SeniorOper = "高级资深干员";
 
-        for (const auto& op : all_ops) {
-            for (auto& rc : rcs_with_single_tag) {
-                if (!op.has_tag(rc.tags.front())) {
-                    continue;
-                }
-                rc.opers.push_back(op);
-                rc.min_level = (std::min)(rc.min_level, op.level);
-                rc.max_level = (std::max)(rc.max_level, op.level);
-                rc.avg_level += op.level;
-            }
-        }
+    const auto& all_opers = recruit_config.get_all_opers();
+    const OperMask& six_star_opers = recruit_config.get_level_opers(6);
+    const size_t tag_size = tags.size();
 
-        for (auto& rc : rcs_with_single_tag) {
-            rc.avg_level /= static_cast<double>(rc.opers.size());
-            // intersection and union are based on sorted container
-            ranges::sort(rc.tags);
-            ranges::sort(rc.opers);
-        }
+    std::vector<const OperMask*> opers_of_tag;
+    opers_of_tag.reserve(tag_size);
+    for (const RecruitConfig::TagId& t : tags) {
+        opers_of_tag.emplace_back(&recruit_config.get_tag_opers(t));
     }
 
     std::vector<RecruitCombs> result;
-    const size_t tag_size = tags.size();
     result.reserve(
         tag_size * (tag_size * tag_size + 5) / 6); // C(size, 3) + C(size, 2) + C(size, 1)
 
+    // 组合的计算全部在位图上完成，只有最终保留下来的组合才展开成干员列表
+    auto emplace_comb = [&](std::initializer_list<size_t> tag_indices, OperMask opers) {
+        const bool has_senior = ranges::any_of(tag_indices, [&](size_t index) {
+            return tags[index] == SeniorOper;
+        });
+        if (!has_senior) {
+            // no senior tag, remove 6-star operators
+            opers &= ~six_star_opers;
+        }
+        if (opers.none()) {
+            return;
+        }
+
+        RecruitCombs comb;
+        for (size_t index : tag_indices) {
+            comb.tags.emplace_back(tags[index]);
+        }
+        ranges::sort(comb.tags);
+
+        size_t total = 0;
+        double level_sum = 0;
+        for (int level = 0; level <= RecruitConfig::MaxLevel; ++level) {
+            const size_t count = (opers & recruit_config.get_level_opers(level)).count();
+            if (count == 0) {
+                continue;
+            }
+            if (total == 0) {
+                comb.min_level = level;
+            }
+            comb.max_level = level;
+            total += count;
+            level_sum += static_cast<double>(level) * static_cast<double>(count);
+        }
+        comb.avg_level = level_sum / static_cast<double>(total);
+
+        comb.opers.reserve(total);
+        for (size_t i = 0; i < all_opers.size(); ++i) {
+            if (opers.test(i)) {
+                comb.opers.emplace_back(all_opers[i]);
+            }
+        }
+        ranges::sort(comb.opers);
+
+        result.emplace_back(std::move(comb));
+    };
+
     // select one tag first
     for (size_t i = 0; i < tag_size; ++i) {
-        RecruitCombs temp1 = rcs_with_single_tag[i];
-        if (temp1.opers.empty()) [[unlikely]] {
-            continue;               // this is not possible
+        const OperMask& opers1 = *opers_of_tag[i];
+        if (opers1.none()) [[unlikely]] {
+            continue; // this is not possible
         }
-        result.emplace_back(temp1); // that is it
+        emplace_comb({ i }, opers1); // that is it
 
         // but what if another tag is also selected
         for (size_t j = i + 1; j < tag_size; ++j) {
-            RecruitCombs temp2 = temp1 * rcs_with_single_tag[j];
-            if (temp2.opers.empty()) [[unlikely]] {
+            const OperMask opers2 = opers1 & *opers_of_tag[j];
+            if (opers2.none()) [[unlikely]] {
                 continue;
             }
-            result.emplace_back(temp2); // two tags only
+            emplace_comb({ i, j }, opers2); // two tags only
 
             // select a third one
             for (size_t k = j + 1; k < tag_size; ++k) {
-                RecruitCombs temp3 = temp2 * rcs_with_single_tag[k];
-                if (temp3.opers.empty()) [[unlikely]] {
+                const OperMask opers3 = opers2 & *opers_of_tag[k];
+                if (opers3.none()) [[unlikely]] {
                     continue;
                 }
-                result.emplace_back(temp3);
+                emplace_comb({ i, j, k }, opers3);
             }
         }
     }
 
-    static constexpr std::string_view SeniorOper = "高级资深干员";
-
-    for (auto comb_iter = result.begin(); comb_iter != result.end();) {
-        if (ranges::find(comb_iter->tags, RecruitConfig::TagId(SeniorOper))
-            != comb_iter->tags.end()) {
-            ++comb_iter;
-            continue;
-        }
-        // no senior tag, remove 6-star operators
-        // assuming sorted by level
-        auto iter =
-            ranges::find_if(comb_iter->opers, [](const Recruitment& op) { return op.level >= 6; });
-        if (iter == comb_iter->opers.end()) {
-            ++comb_iter;
-            continue;
-        }
-        comb_iter->opers.erase(iter, comb_iter->opers.end());
-        if (comb_iter->opers.empty()) {
-            comb_iter = result.erase(comb_iter);
-            continue;
-        }
-        comb_iter->update_attributes();
-        ++comb_iter;
-    }
-
     return result;
 }
 } // namespace asst::recruit_calc
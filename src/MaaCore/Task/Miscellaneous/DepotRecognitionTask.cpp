@@ -1,13 +1,12 @@
 #include "DepotRecognitionTask.h"
 
-#include <future>
+#include <tuple>
 
 #include <meojson/json.hpp>
 
 #include "Config/GeneralConfig.h"
 #include "Config/TaskData.h"
 #include "Controller/Controller.h"
-#include "Task/ProcessTask.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Miscellaneous/DepotImageAnalyzer.h"
 
@@ -30,7 +29,7 @@ bool asst::DepotRecognitionTask::swipe_and_analyze()
     while (true) {
         DepotImageAnalyzer analyzer(ctrler()->get_image());
 
-        auto future = std::async(std::launch::async, [&]() { swipe(); });
+        const auto swipe_token = swipe_async();
 
         // 因为滑动不是完整的一页，有可能上一次识别过的物品，这次仍然在页面中
         // 所以这个 begin pos 不能设置
@@ -47,7 +46,9 @@ bool asst::DepotRecognitionTask::swipe_and_analyze()
         auto cur_result = analyzer.get_result();
         m_all_items.merge(std::move(cur_result));
 
-        future.wait();
+        if (!wait_swipe(swipe_token)) {
+            break;
+        }
         callback_analyze_result(false);
     }
     return !m_all_items.empty();
@@ -92,7 +93,23 @@ void asst::DepotRecognitionTask::callback_analyze_result(bool done)
     callback(AsstMsg::SubTaskExtraInfo, info);
 }
 
-void asst::DepotRecognitionTask::swipe()
+asst::Controller::InputToken asst::DepotRecognitionTask::swipe_async()
+{
+    // 只提交滑动，不等它完成，识别当前页的同时滑到下一页
+    const auto swipe_task = Task.get("DepotSlowlySwipeToTheRight");
+    const auto& params = swipe_task->special_params;
+    return ctrler()->swipe_async(
+        swipe_task->specific_rect,
+        swipe_task->rect_move,
+        params.size() > 0 ? params.at(0) : 0,
+        params.size() > 1 ? params.at(1) : false,
+        params.size() > 2 ? params.at(2) : 1,
+        params.size() > 3 ? params.at(3) : 1);
+}
+
+bool asst::DepotRecognitionTask::wait_swipe(Controller::InputToken token)
 {
-    ProcessTask(*this, { "DepotSlowlySwipeToTheRight" }).run();
+    const int post_delay = Task.get("DepotSlowlySwipeToTheRight")->post_delay;
+    std::ignore = ctrler()->wait_input(token);
+    return sleep(post_delay);
 }
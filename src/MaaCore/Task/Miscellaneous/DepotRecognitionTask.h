@@ -3,6 +3,7 @@
 
 #include <unordered_map>
 
+#include "Controller/Controller.h"
 #include "Vision/Miscellaneous/DepotImageAnalyzer.h"
 
 namespace asst
@@ -18,7 +19,8 @@ namespace asst
 
         bool swipe_and_analyze();
         void callback_analyze_result(bool done);
-        void swipe();
+        Controller::InputToken swipe_async();
+        bool wait_swipe(Controller::InputToken token);
         std::unordered_map<std::string, ItemInfo> m_all_items;
     };
 }
@@ -2,12 +2,11 @@
 
 #include "Utils/Ranges.hpp"
 
-#include <future>
+#include <tuple>
 
 #include "Config/Miscellaneous/BattleDataConfig.h"
 #include "Config/TaskData.h"
 #include "Controller/Controller.h"
-#include "Task/ProcessTask.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Miscellaneous/OperBoxImageAnalyzer.h"
 #include "Vision/TemplDetOCRer.h"
@@ -30,7 +29,7 @@ bool asst::OperBoxRecognitionTask::swipe_and_analyze()
     while (!need_exit()) {
         OperBoxImageAnalyzer analyzer(ctrler()->get_image());
 
-        auto future = std::async(std::launch::async, [&]() { swipe_page(); });
+        const auto swipe_token = swipe_page_async();
 
         if (!analyzer.analyze()) {
             break;
@@ -48,14 +47,32 @@ bool asst::OperBoxRecognitionTask::swipe_and_analyze()
             m_own_opers.emplace(box_info.name, box_info);
         }
         callback_analyze_result(false);
-        future.wait();
+        if (!wait_swipe(swipe_token)) {
+            break;
+        }
     }
     return !m_own_opers.empty();
 }
 
-void asst::OperBoxRecognitionTask::swipe_page()
+asst::Controller::InputToken asst::OperBoxRecognitionTask::swipe_page_async()
+{
+    // 只提交滑动，不等它完成，识别当前页的同时滑到下一页
+    const auto swipe_task = Task.get("OperBoxSlowlySwipeToTheRight");
+    const auto& params = swipe_task->special_params;
+    return ctrler()->swipe_async(
+        swipe_task->specific_rect,
+        swipe_task->rect_move,
+        params.size() > 0 ? params.at(0) : 0,
+        params.size() > 1 ? params.at(1) : false,
+        params.size() > 2 ? params.at(2) : 1,
+        params.size() > 3 ? params.at(3) : 1);
+}
+
+bool asst::OperBoxRecognitionTask::wait_swipe(Controller::InputToken token)
 {
-    ProcessTask(*this, { "OperBoxSlowlySwipeToTheRight" }).run();
+    const int post_delay = Task.get("OperBoxSlowlySwipeToTheRight")->post_delay;
+    std::ignore = ctrler()->wait_input(token);
+    return sleep(post_delay);
 }
 
 void asst::OperBoxRecognitionTask::callback_analyze_result(bool done)
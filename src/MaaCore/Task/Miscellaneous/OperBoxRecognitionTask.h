@@ -1,5 +1,6 @@
 #pragma once
 #include "Common/AsstBattleDef.h"
+#include "Controller/Controller.h"
 #include "Task/AbstractTask.h"
 #include "Vision/Miscellaneous/OperBoxImageAnalyzer.h"
 
@@ -13,7 +14,8 @@ namespace asst
 
     protected:
         virtual bool _run() override;
-        void swipe_page();
+        Controller::InputToken swipe_page_async();
+        bool wait_swipe(Controller::InputToken token);
         void callback_analyze_result(bool done);
         bool swipe_and_analyze();
 
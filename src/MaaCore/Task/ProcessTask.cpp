@@ -9,6 +9,7 @@
 #include "Config/GeneralConfig.h"
 #include "Config/TaskData.h"
 #include "Controller/Controller.h"
+#include "PerfStats.h"
 #include "Status.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Miscellaneous/PipelineAnalyzer.h"
@@ -261,8 +262,13 @@ ProcessTask::NodeStatus ProcessTask::run_task(const HitDetail& hits)
     }
 
     // 根据任务的 action 执行任务
-    if (auto result = run_action(hits); result != NodeStatus::Success) {
-        return result;
+    NodeStatus action_result = NodeStatus::Success;
+    {
+        PerfStats::Scope perf_scope(PerfStats::Category::Pipeline, task_name);
+        action_result = run_action(hits);
+    }
+    if (action_result != NodeStatus::Success) {
+        return action_result;
     }
 
     status()->set_number(Status::ProcessTaskLastTimePrefix + task_name, time(nullptr));
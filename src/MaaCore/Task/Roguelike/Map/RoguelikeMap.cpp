@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <queue>
 
 #include "Utils/Logger.hpp"
 #include "Utils/Ranges.hpp"
@@ -33,6 +34,7 @@ void asst::RoguelikeMap::add_edge(const size_t& source, const size_t& target)
     const RoguelikeNodePtr& target_node = m_nodes.at(target);
     source_node->succs.emplace_back(target);
     target_node->preds.emplace_back(source);
+    invalidate_node_cost(source);
     Log.info(__FUNCTION__, "| Node", source, "-> Node", target);
 }
 
@@ -47,15 +49,114 @@ void asst::RoguelikeMap::set_curr_pos(const size_t& node_index)
     m_curr_pos = node_index;
 }
 
+void asst::RoguelikeMap::set_cost_fun(const RoguelikeNodeCostFun& cost_fun)
+{
+    m_cost_fun = cost_fun;
+    for (const RoguelikeNodePtr& node : m_nodes) {
+        node->cost_dirty = true;
+    }
+}
+
+void asst::RoguelikeMap::set_full_path_cost(bool full_path)
+{
+    if (m_full_path_cost == full_path) {
+        return;
+    }
+    m_full_path_cost = full_path;
+    for (const RoguelikeNodePtr& node : m_nodes) {
+        node->cost_dirty = true;
+    }
+}
+
+void asst::RoguelikeMap::set_max_cost(int max_cost)
+{
+    if (m_max_cost == max_cost) {
+        return;
+    }
+    m_max_cost = max_cost;
+    for (const RoguelikeNodePtr& node : m_nodes) {
+        node->cost_dirty = true;
+    }
+}
+
 void asst::RoguelikeMap::update_node_costs()
 {
-    for (const RoguelikeNodePtr& node : ranges::reverse_view(m_nodes)) {
-        node->cost = m_cost_fun(node);
-        if (!node->succs.empty()) {
-            auto succ_costs = node->succs | views::transform([&](const size_t node_index) {
-                                  return m_cost_fun(m_nodes.at(node_index));
-                              });
-            node->cost += ranges::min(succ_costs);
+    if (!m_full_path_cost) {
+        // 只向后看一步，先把自身代价都算好，再取后继中最小的
+        for (const RoguelikeNodePtr& node : m_nodes) {
+            if (node->cost_dirty) {
+                node->self_cost = m_cost_fun(node);
+            }
+        }
+        for (const RoguelikeNodePtr& node : m_nodes) {
+            if (!node->cost_dirty) {
+                continue;
+            }
+            node->cost = node->self_cost >= m_max_cost ? UnreachableCost : node->self_cost;
+            if (node->cost != UnreachableCost && !node->succs.empty()) {
+                auto succ_costs =
+                    node->succs | views::transform([&](const size_t index) { return m_nodes.at(index)->self_cost; });
+                const int min_succ_cost = ranges::min(succ_costs);
+                node->cost = min_succ_cost >= m_max_cost ? UnreachableCost : node->cost + min_succ_cost;
+            }
+            node->cost_dirty = false;
+        }
+        return;
+    }
+
+    // 按列从后往前做动态规划，计算某列时后面各列的 cost 都已经是最新的
+    // 同列节点之间也有连线，列内再做几轮松弛
+    for (size_t column = m_column_indices.size(); column-- > 0;) {
+        const size_t begin = get_column_begin(column);
+        const size_t end = get_column_end(column);
+        const bool dirty = std::any_of(m_nodes.begin() + static_cast<std::ptrdiff_t>(begin),
+                                       m_nodes.begin() + static_cast<std::ptrdiff_t>(end),
+                                       [](const RoguelikeNodePtr& node) { return node->cost_dirty; });
+        if (!dirty) {
+            continue;
+        }
+
+        // 不可通过的节点及其后继全都走不通的节点保持 UnreachableCost
+        for (size_t index = begin; index < end; ++index) {
+            const RoguelikeNodePtr& node = m_nodes.at(index);
+            node->self_cost = m_cost_fun(node);
+            node->cost = node->succs.empty() && node->self_cost < m_max_cost ? node->self_cost : UnreachableCost;
+            if (node->self_cost >= m_max_cost) {
+                continue;
+            }
+            for (const size_t succ : node->succs) {
+                const int succ_cost = m_nodes.at(succ)->cost;
+                if (is_forward_edge(index, succ) && succ_cost != UnreachableCost) {
+                    node->cost = (std::min)(node->cost, node->self_cost + succ_cost);
+                }
+            }
+        }
+
+        for (size_t round = begin; round < end; ++round) {
+            bool changed = false;
+            for (size_t index = begin; index < end; ++index) {
+                const RoguelikeNodePtr& node = m_nodes.at(index);
+                if (node->self_cost >= m_max_cost) {
+                    continue;
+                }
+                for (const size_t succ : node->succs) {
+                    const int succ_cost = m_nodes.at(succ)->cost;
+                    if (m_nodes.at(succ)->column != node->column || succ_cost == UnreachableCost) {
+                        continue;
+                    }
+                    if (node->self_cost + succ_cost < node->cost) {
+                        node->cost = node->self_cost + succ_cost;
+                        changed = true;
+                    }
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+
+        for (size_t index = begin; index < end; ++index) {
+            m_nodes.at(index)->cost_dirty = false;
         }
     }
 }
@@ -101,11 +202,68 @@ size_t asst::RoguelikeMap::get_next_node() const
         return m_curr_pos;
     }
 
-    const size_t next_index =
-        ranges::min(curr->succs, [&](const size_t& node1_index, const size_t& node2_index) {
-            return m_nodes.at(node1_index)->cost < m_nodes.at(node2_index)->cost;
-        });
-    return next_index;
+    auto cost_less = [&](const size_t& node1_index, const size_t& node2_index) {
+        return m_nodes.at(node1_index)->cost < m_nodes.at(node2_index)->cost;
+    };
+
+    // 不在当前列内移动
+    auto forward_succs =
+        curr->succs | views::filter([&](const size_t& node_index) { return is_forward_edge(m_curr_pos, node_index); });
+    if (forward_succs.begin() == forward_succs.end()) {
+        Log.warn(__FUNCTION__, "| no successor nodes in the following columns");
+        return m_curr_pos;
+    }
+    return ranges::min(forward_succs, cost_less);
+}
+
+std::vector<asst::RoguelikeRoute> asst::RoguelikeMap::get_best_routes(size_t k) const
+{
+    // 以各节点的 cost 作为剩余代价的下界做 best-first 搜索，完整路线按代价从小到大依次出队
+    struct PartialRoute
+    {
+        int priority = 0; // 已走过的代价 + 末节点的 cost
+        int passed = 0;   // 末节点之前已走过的代价
+        std::vector<size_t> nodes;
+    };
+    auto greater = [](const PartialRoute& lhs, const PartialRoute& rhs) { return lhs.priority > rhs.priority; };
+    std::priority_queue<PartialRoute, std::vector<PartialRoute>, decltype(greater)> queue(greater);
+
+    for (const size_t succ : m_nodes.at(m_curr_pos)->succs) {
+        if (is_forward_edge(m_curr_pos, succ) && m_nodes.at(succ)->cost != UnreachableCost) {
+            queue.push(PartialRoute { .priority = m_nodes.at(succ)->cost, .passed = 0, .nodes = { succ } });
+        }
+    }
+
+    std::vector<RoguelikeRoute> routes;
+    size_t expansions = 0;
+    while (!queue.empty() && routes.size() < k && expansions++ < MaxRouteExpansions) {
+        PartialRoute route = queue.top();
+        queue.pop();
+
+        const size_t last = route.nodes.back();
+        const RoguelikeNodePtr& node = m_nodes.at(last);
+        const int passed = route.passed + node->self_cost;
+
+        bool has_next = false;
+        for (const size_t succ : node->succs) {
+            const RoguelikeNodePtr& succ_node = m_nodes.at(succ);
+            if (succ_node->column < node->column) {
+                continue;
+            }
+            has_next = true;
+            if (succ == m_curr_pos || succ_node->cost == UnreachableCost ||
+                ranges::find(route.nodes, succ) != route.nodes.end()) {
+                continue;
+            }
+            PartialRoute next { .priority = passed + succ_node->cost, .passed = passed, .nodes = route.nodes };
+            next.nodes.emplace_back(succ);
+            queue.push(std::move(next));
+        }
+        if (!has_next) {
+            routes.emplace_back(RoguelikeRoute { .cost = passed, .nodes = std::move(route.nodes) });
+        }
+    }
+    return routes;
 }
 
 // ————————————————————————————————————————————————————————————————————————————————
@@ -213,17 +371,29 @@ int asst::RoguelikeMap::get_node_refresh_times(const size_t& node_index) const
 
 void asst::RoguelikeMap::set_node_type(const size_t& node_index, RoguelikeNodeType type)
 {
+    if (m_nodes.at(node_index)->type == type) {
+        return;
+    }
     m_nodes.at(node_index)->type = type;
+    invalidate_node_cost(node_index);
 }
 
 void asst::RoguelikeMap::set_node_visited(const size_t& node_index, bool visisted)
 {
+    if (m_nodes.at(node_index)->visited == visisted) {
+        return;
+    }
     m_nodes.at(node_index)->visited = visisted;
+    invalidate_node_cost(node_index);
 }
 
 void asst::RoguelikeMap::set_node_refresh_times(const size_t& node_index, int refresh_times)
 {
+    if (m_nodes.at(node_index)->refresh_times == refresh_times) {
+        return;
+    }
     m_nodes.at(node_index)->refresh_times = refresh_times;
+    invalidate_node_cost(node_index);
 }
 
 // ================================================================================
@@ -269,3 +439,30 @@ std::optional<size_t> asst::RoguelikeMap::insert_node(const RoguelikeNodePtr& no
 
     return index;
 }
+
+void asst::RoguelikeMap::invalidate_node_cost(const size_t& node_index)
+{
+    // 节点的 cost 依赖其所有后继，所以要沿前驱一路标记上去
+    // 已经标记过的节点，其前驱也一定已经标记过了
+    std::vector<size_t> pending = { node_index };
+    while (!pending.empty()) {
+        const size_t index = pending.back();
+        pending.pop_back();
+
+        const RoguelikeNodePtr& node = m_nodes.at(index);
+        if (node->cost_dirty && index != node_index) {
+            continue;
+        }
+        node->cost_dirty = true;
+        for (const size_t pred : node->preds) {
+            if (!m_nodes.at(pred)->cost_dirty) {
+                pending.emplace_back(pred);
+            }
+        }
+    }
+}
+
+bool asst::RoguelikeMap::is_forward_edge(const size_t& source, const size_t& target) const
+{
+    return m_nodes.at(target)->column > m_nodes.at(source)->column;
+}
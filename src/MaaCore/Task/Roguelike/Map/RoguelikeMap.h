@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -41,7 +42,9 @@ struct RoguelikeNode
     bool visited = false;
     std::vector<size_t> succs; // successors 在 RoguelikeMap().m_nodes 中的 index
     std::vector<size_t> preds; // predecessors 在 RoguelikeMap().m_nodes 中的 index
-    int cost = 0;
+    int cost = 0;              // 该节点（含）往后的代价，见 RoguelikeMap::set_full_path_cost；无路可走时为 UnreachableCost
+    int self_cost = 0;         // 该节点自身的代价，即 cost_fun(node)
+    bool cost_dirty = true;    // cost 是否需要重新计算
     // –––––––– 萨卡兹主题引入 ––––––––––––––––––––––––
     int refresh_times = 0;
 
@@ -56,6 +59,12 @@ struct RoguelikeNode
 using RoguelikeNodePtr = std::shared_ptr<RoguelikeNode>;
 using RoguelikeNodeCostFun = std::function<int(const RoguelikeNodePtr&)>;
 
+struct RoguelikeRoute
+{
+    int cost = 0;
+    std::vector<size_t> nodes; // 不含起点
+};
+
 // ================================================================================
 // Q: RoguelikeMap 应该支持哪些功能？
 // A: 原则上我希望 RoguelikeNode 和 RoguelikeNodePtr 仅在RoguelikeMap 内部调用
@@ -74,7 +83,13 @@ public:
 
     void add_edge(const size_t& source, const size_t& target);
     void set_curr_pos(const size_t& node_index);
-    void set_cost_fun(const RoguelikeNodeCostFun& cost_fun) { m_cost_fun = cost_fun; }
+    void set_cost_fun(const RoguelikeNodeCostFun& cost_fun);
+    // true（默认）: cost 为从该节点走到终点的最小总代价
+    // false: cost 为自身代价加上后继中最小的自身代价，只向后看一步
+    void set_full_path_cost(bool full_path);
+    // 自身代价不低于 max_cost 的节点不可通过，经过它们才能走下去的节点 cost 为 UnreachableCost
+    void set_max_cost(int max_cost);
+    // 只重新计算类型、访问、刷新状态或连边有变化的节点（及其前驱）
     void update_node_costs();
     void reset();
 
@@ -85,6 +100,8 @@ public:
     size_t get_column_begin(const size_t& column) const;
     size_t get_column_end(const size_t& column) const;
     size_t get_next_node() const;
+    // 从当前位置出发代价最小的 k 条路线（不重复经过同一节点），按代价从小到大排列
+    std::vector<RoguelikeRoute> get_best_routes(size_t k) const;
 
     // ———————— get node fields ———————————————————————————————————————————————————————
     RoguelikeNodeType get_node_type(const size_t& node_index) const;
@@ -103,15 +120,21 @@ public:
 
     // ———————— constants and variables ———————————————————————————————————————————————
     const size_t init_index = 0;        // 常量，既是 init 的 node index 也是它的 column index
+    static constexpr int UnreachableCost = std::numeric_limits<int>::max();
 
 private:
     // ———————— update map ————————————————————————————————————————————————————————————
     std::optional<size_t> insert_node(const RoguelikeNodePtr& node, const size_t& column);
+    void invalidate_node_cost(const size_t& node_index);
+    bool is_forward_edge(const size_t& source, const size_t& target) const;
 
     // ———————— constants and variables ———————————————————————————————————————————————
     std::vector<RoguelikeNodePtr> m_nodes;
     std::vector<size_t> m_column_indices; // m_column_indices[c] 代表列 c 的 node index 的上限 (exclusive)
     size_t m_curr_pos = 0;                // 当前位置的 node index
+    static constexpr size_t MaxRouteExpansions = 10000; // get_best_routes 最多展开的部分路线数
+    bool m_full_path_cost = true;
+    int m_max_cost = std::numeric_limits<int>::max();
     RoguelikeNodeCostFun m_cost_fun = [&]([[maybe_unused]] const RoguelikeNodePtr& node) { return 0; };
 };
 }
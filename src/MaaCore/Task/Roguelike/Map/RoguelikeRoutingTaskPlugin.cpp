@@ -34,6 +34,12 @@ bool asst::RoguelikeRoutingTaskPlugin::load_params([[maybe_unused]] const json::
     m_roi_margin = config->special_params.at(7);
     m_direction_threshold = config->special_params.at(8);
 
+    // 复制一份，资源重新加载时不受影响
+    const RoguelikeRouteCostModel cost_model = RoguelikeMapInfo.get_cost_model(theme);
+    m_map.set_full_path_cost(cost_model.full_path);
+    m_map.set_max_cost(cost_model.max_cost);
+    m_map.set_cost_fun([cost_model](const RoguelikeNodePtr& node) { return cost_model.evaluate(*node); });
+
     return true;
 }
 
@@ -262,30 +268,17 @@ void asst::RoguelikeRoutingTaskPlugin::navigate_route()
 {
     LogTraceFunction;
 
-    const size_t curr_column = m_map.get_node_column(m_map.get_curr_pos());
-
-    m_map.set_cost_fun([&](const RoguelikeNodePtr& node) {
-        if (node->visited) {
-            return 1000;
-        }
-
-        if (node->column == curr_column) {
-            return 1000;
-        }
-
-        if (node->type == RoguelikeNodeType::CombatOps || node->type == RoguelikeNodeType::EmergencyOps ||
-            node->type == RoguelikeNodeType::DreadfulFoe) {
-            return 1 + (node->refresh_times ? 999 : 0);
-        }
-
-        return 0;
-    });
-
     m_map.update_node_costs();
 
+    for (const RoguelikeRoute& route : m_map.get_best_routes(RouteLogCount)) {
+        Log.info(__FUNCTION__, "| route cost:", route.cost, ", nodes:", route.nodes);
+    }
+
+    // 当前列的节点不作为下一步，没有后续列的节点时 get_next_node 返回当前位置
+    // 下一步只能走到不可通过的节点（如刷新过的战斗节点）或走下去必经这样的节点时，放弃本次探索
     const size_t next_node = m_map.get_next_node();
 
-    if (m_map.get_node_cost(next_node) >= 1000) {
+    if (next_node == m_map.get_curr_pos() || m_map.get_node_cost(next_node) == RoguelikeMap::UnreachableCost) {
         Task.set_task_base("Sarkaz@Roguelike@RoutingAction", "Sarkaz@Roguelike@ExitThenAbandon");
         reset_in_run_variables();
         return;
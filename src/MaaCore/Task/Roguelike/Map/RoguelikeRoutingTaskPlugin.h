@@ -40,5 +40,7 @@ private:
     int m_nameplate_offset = 0;      // 节点 Rect 下边缘到节点铭牌下边缘的距离
     int m_roi_margin = 0;            // roi 时的 margin offset
     int m_direction_threshold = 0;   // 节点间连线方向判定的阈值
+
+    static constexpr size_t RouteLogCount = 3; // 日志中输出的候选路线数
 };
 }
@@ -24,6 +24,36 @@
 using namespace asst::battle;
 using namespace asst::battle::roguelike;
 
+// 攻击范围覆盖表中各朝向的顺序
+static constexpr std::array<DeployDirection, 4> DirectionOrder = {
+    DeployDirection::Right,
+    DeployDirection::Up,
+    DeployDirection::Left,
+    DeployDirection::Down,
+};
+
+using TileKey = asst::TilePack::TileKey;
+// 战斗干员朝向的权重
+static const std::unordered_map<TileKey, int> TileKeyFightWeights = {
+    { TileKey::Invalid, 0 },    { TileKey::Forbidden, 0 },
+    { TileKey::Wall, 500 },     { TileKey::Road, 1000 },
+    { TileKey::Home, 500 },     { TileKey::EnemyHome, 1000 },
+    { TileKey::Airport, 1000 }, { TileKey::Floor, 1000 },
+    { TileKey::Hole, 0 },       { TileKey::Telin, 700 },
+    { TileKey::Telout, 800 },   { TileKey::Grass, 500 },
+    { TileKey::DeepSea, 1000 }, { TileKey::Volcano, 1000 },
+    { TileKey::Healing, 1000 }, { TileKey::Fence, 800 },
+};
+// 治疗干员朝向的权重
+static const std::unordered_map<TileKey, int> TileKeyMedicWeights = {
+    { TileKey::Invalid, 0 },  { TileKey::Forbidden, 0 },  { TileKey::Wall, 1000 },
+    { TileKey::Road, 1000 },  { TileKey::Home, 0 },       { TileKey::EnemyHome, 0 },
+    { TileKey::Airport, 0 },  { TileKey::Floor, 0 },      { TileKey::Hole, 0 },
+    { TileKey::Telin, 0 },    { TileKey::Telout, 0 },     { TileKey::Grass, 500 },
+    { TileKey::DeepSea, 0 },  { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
+    { TileKey::Fence, 1000 },
+};
+
 asst::RoguelikeBattleTaskPlugin::RoguelikeBattleTaskPlugin(
     const AsstCallback& callback,
     Assistant* inst,
@@ -170,6 +200,15 @@ bool asst::RoguelikeBattleTaskPlugin::calc_stage_info()
             auto calc_result = TilePack::calc(m_map_data);
             m_normal_tile_info = std::move(calc_result.normal_tile_info);
             m_side_tile_info = std::move(calc_result.side_tile_info);
+            m_tile_indices.clear();
+            m_coverage_tables.clear();
+            for (const Point& loc : m_side_tile_info | views::keys) {
+                if (m_tile_indices.size() >= MaxTileCount) {
+                    Log.warn("too many tiles", m_side_tile_info.size());
+                    break;
+                }
+                m_tile_indices.emplace(loc, m_tile_indices.size());
+            }
             m_retreat_button_pos = calc_result.retreat_button;
             m_skill_button_pos = calc_result.skill_button;
             break;
@@ -851,7 +890,7 @@ void asst::RoguelikeBattleTaskPlugin::all_melee_retreat()
 {
     std::vector<Point> retreat_locs {};
     for (const auto& loc : m_used_tiles | views::keys) {
-        auto& tile_info = m_normal_tile_info[loc];
+        auto& tile_info = m_normal_tile_info.at(loc);
         auto& type = tile_info.buildable;
         if (type == battle::LocationType::Melee || type == battle::LocationType::All) {
             retreat_locs.push_back(loc);
@@ -872,6 +911,8 @@ void asst::RoguelikeBattleTaskPlugin::clear()
     m_blacklist_location.clear();
     m_force_deploy_direction.clear();
     m_force_air_defense = decltype(m_force_air_defense)();
+    m_tile_indices.clear();
+    m_coverage_tables.clear();
 
     m_cur_home_index = 0;
     m_first_deploy = true;
@@ -1020,11 +1061,13 @@ std::optional<asst::RoguelikeBattleTaskPlugin::DeployInfo>
     const auto& near_loc = available_loc.front();
     int min_dist = std::abs(near_loc.x - home.location.x) + std::abs(near_loc.y - home.location.y);
 
-    // 取距离最近的N个点，计算分数。然后使用得分最高的点
+    // 取距离最近的N个点，计算分数（覆盖情况查表得到）。然后使用得分最高的点
     constexpr int CalcPointCount = 4;
+    const CoverageTable& coverage_table = get_coverage_table(oper);
+    const TileMask occupied = oper.role == battle::Role::Medic ? get_occupied_mask() : TileMask();
     for (const auto& loc : available_loc | views::take(CalcPointCount)) {
         const auto& [cur_direction, cur_socre] =
-            calc_best_direction_and_score(loc, oper, home.direction);
+            calc_best_direction_and_score(loc, oper, home.direction, coverage_table, occupied);
         // 离得远的要扣分
         constexpr int DistWeights = -1050;
         int extra_dist =
@@ -1056,10 +1099,10 @@ asst::RoguelikeBattleTaskPlugin::DirectionAndScore
     asst::RoguelikeBattleTaskPlugin::calc_best_direction_and_score(
         Point loc,
         const battle::DeploymentOper& oper,
-        DeployDirection recommended_direction) const
+        DeployDirection recommended_direction,
+        const CoverageTable& coverage_table,
+        const TileMask& occupied) const
 {
-    LogTraceFunction;
-
     size_t home_index = m_cur_home_index;
     if (home_index >= m_homes.size()) {
         Log.warn("home index is out of range", m_cur_home_index, m_homes.size());
@@ -1112,57 +1155,26 @@ asst::RoguelikeBattleTaskPlugin::DirectionAndScore
     int max_score = 0;
     DeployDirection best_direction = DeployDirection::None;
 
-    for (auto direction : { DeployDirection::Right,
-                            DeployDirection::Up,
-                            DeployDirection::Left,
-                            DeployDirection::Down }) {
-        int score = 0;
-        // 按朝右算，后面根据方向做转换
-        for (const Point& relative_pos : get_attack_range(oper, direction)) {
-            Point absolute_pos = loc + relative_pos;
-
-            using TileKey = TilePack::TileKey;
-            // 战斗干员朝向的权重
-            static const std::unordered_map<TileKey, int> TileKeyFightWeights = {
-                { TileKey::Invalid, 0 },    { TileKey::Forbidden, 0 },
-                { TileKey::Wall, 500 },     { TileKey::Road, 1000 },
-                { TileKey::Home, 500 },     { TileKey::EnemyHome, 1000 },
-                { TileKey::Airport, 1000 }, { TileKey::Floor, 1000 },
-                { TileKey::Hole, 0 },       { TileKey::Telin, 700 },
-                { TileKey::Telout, 800 },   { TileKey::Grass, 500 },
-                { TileKey::DeepSea, 1000 }, { TileKey::Volcano, 1000 },
-                { TileKey::Healing, 1000 }, { TileKey::Fence, 800 },
-            };
-            // 治疗干员朝向的权重
-            static const std::unordered_map<TileKey, int> TileKeyMedicWeights = {
-                { TileKey::Invalid, 0 },  { TileKey::Forbidden, 0 },  { TileKey::Wall, 1000 },
-                { TileKey::Road, 1000 },  { TileKey::Home, 0 },       { TileKey::EnemyHome, 0 },
-                { TileKey::Airport, 0 },  { TileKey::Floor, 0 },      { TileKey::Hole, 0 },
-                { TileKey::Telin, 0 },    { TileKey::Telout, 0 },     { TileKey::Grass, 500 },
-                { TileKey::DeepSea, 0 },  { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
-                { TileKey::Fence, 1000 },
-            };
+    auto coverage_iter = coverage_table.find(loc);
+    if (coverage_iter == coverage_table.end()) {
+        Log.error("No coverage of location", loc.to_string());
+        return { best_direction, max_score };
+    }
 
-            switch (oper.role) {
-            case battle::Role::Medic:
-                if (auto iter = m_used_tiles.find(absolute_pos);
-                    iter != m_used_tiles.cend()
-                    && BattleData.get_role(iter->second)
-                           != battle::Role::Drone) { // 根据哪个方向上人多决定朝向哪
-                    score += 10000;
-                }
-                if (auto iter = m_side_tile_info.find(absolute_pos);
-                    iter != m_side_tile_info.end()) {
-                    score += TileKeyMedicWeights.at(iter->second.key);
-                }
-                break;
-            default:
-                if (auto iter = m_side_tile_info.find(absolute_pos);
-                    iter != m_side_tile_info.end()) {
-                    score += TileKeyFightWeights.at(iter->second.key);
-                }
-                break;
-            }
+    for (size_t direction_index = 0; direction_index < DirectionOrder.size(); ++direction_index) {
+        const DeployDirection direction = DirectionOrder[direction_index];
+        const RangeCoverage& coverage = coverage_iter->second[direction_index];
+
+        int score = 0;
+        switch (oper.role) {
+        case battle::Role::Medic:
+            // 根据哪个方向上人多决定朝向哪
+            score += static_cast<int>((coverage.covered & occupied).count()) * 10000;
+            score += coverage.medic_score;
+            break;
+        default:
+            score += coverage.fight_score;
+            break;
         }
 
         if (direction == base_direction) {
@@ -1182,3 +1194,49 @@ asst::RoguelikeBattleTaskPlugin::DirectionAndScore
 
     return { best_direction, max_score };
 }
+
+const asst::RoguelikeBattleTaskPlugin::CoverageTable&
+    asst::RoguelikeBattleTaskPlugin::get_coverage_table(const battle::DeploymentOper& oper) const
+{
+    battle::AttackRange right_attack_range = get_attack_range(oper, DeployDirection::Right);
+    if (auto iter = m_coverage_tables.find(right_attack_range); iter != m_coverage_tables.end()) {
+        return iter->second;
+    }
+
+    LogTraceFunction;
+
+    CoverageTable table;
+    for (size_t direction_index = 0; direction_index < DirectionOrder.size(); ++direction_index) {
+        const battle::AttackRange attack_range = get_attack_range(oper, DirectionOrder[direction_index]);
+        for (const Point& loc : m_normal_tile_info | views::keys) {
+            RangeCoverage& coverage = table[loc][direction_index];
+            for (const Point& relative_pos : attack_range) {
+                const Point absolute_pos = loc + relative_pos;
+                auto tile_iter = m_side_tile_info.find(absolute_pos);
+                if (tile_iter == m_side_tile_info.end()) {
+                    continue;
+                }
+                coverage.fight_score += TileKeyFightWeights.at(tile_iter->second.key);
+                coverage.medic_score += TileKeyMedicWeights.at(tile_iter->second.key);
+                if (auto index_iter = m_tile_indices.find(absolute_pos); index_iter != m_tile_indices.end()) {
+                    coverage.covered.set(index_iter->second);
+                }
+            }
+        }
+    }
+    return m_coverage_tables.emplace(std::move(right_attack_range), std::move(table)).first->second;
+}
+
+asst::RoguelikeBattleTaskPlugin::TileMask asst::RoguelikeBattleTaskPlugin::get_occupied_mask() const
+{
+    TileMask occupied;
+    for (const auto& [loc, name] : m_used_tiles) {
+        if (BattleData.get_role(name) == battle::Role::Drone) {
+            continue;
+        }
+        if (auto iter = m_tile_indices.find(loc); iter != m_tile_indices.end()) {
+            occupied.set(iter->second);
+        }
+    }
+    return occupied;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bitset>
 #include <queue>
 #include <stack>
 
@@ -72,8 +73,22 @@ namespace asst
             battle::DeployDirection direction;
             int score = 0;
         };
+        // 每种攻击范围在各可部署地块、各朝向上覆盖的格子及其权重，每关按需计算一次
+        static constexpr size_t MaxTileCount = 1024;
+        using TileMask = std::bitset<MaxTileCount>; // 下标为 m_tile_indices 中的编号
+        struct RangeCoverage
+        {
+            int fight_score = 0; // 覆盖格子的战斗朝向权重之和
+            int medic_score = 0; // 覆盖格子的治疗朝向权重之和
+            TileMask covered;
+        };
+        using CoverageTable = std::unordered_map<Point, std::array<RangeCoverage, 4>>; // 朝向依次为右上左下
+        const CoverageTable& get_coverage_table(const battle::DeploymentOper& oper) const;
+        TileMask get_occupied_mask() const; // 被非召唤物干员占据的格子
         DirectionAndScore calc_best_direction_and_score(Point loc, const battle::DeploymentOper& oper,
-                                                        battle::DeployDirection recommended_direction) const;
+                                                        battle::DeployDirection recommended_direction,
+                                                        const CoverageTable& coverage_table,
+                                                        const TileMask& occupied) const;
 
         void postproc_of_deployment_conditions(const battle::DeploymentOper& oper, const Point& placed_loc,
                                                battle::DeployDirection direction);
@@ -147,6 +162,9 @@ namespace asst
         std::vector<battle::roguelike::DeployInfoWithRank> m_retreat_plan;
         std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_deployed_time;
 
+        std::unordered_map<Point, size_t> m_tile_indices; // 地块在 TileMask 中的编号
+        mutable std::map<battle::AttackRange, CoverageTable> m_coverage_tables;
+
         // 缓存干员精英
         std::unordered_map<std::string, int64_t> m_oper_elite;
         // 缓存干员精英情况
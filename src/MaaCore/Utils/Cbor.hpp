@@ -0,0 +1,120 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <meojson/json.hpp>
+
+// 把 json::value 编码为 CBOR (RFC 8949)，供批量回调使用，省去 json 字符串的序列化与外部的再解析
+namespace asst::utils::cbor
+{
+    inline void append_head(std::string& out, uint8_t major_type, uint64_t value)
+    {
+        const auto type = static_cast<uint8_t>(major_type << 5);
+        if (value < 24) {
+            out.push_back(static_cast<char>(type | value));
+            return;
+        }
+
+        int bytes = 8;
+        uint8_t info = 27;
+        if (value <= 0xff) {
+            bytes = 1;
+            info = 24;
+        }
+        else if (value <= 0xffff) {
+            bytes = 2;
+            info = 25;
+        }
+        else if (value <= 0xffffffff) {
+            bytes = 4;
+            info = 26;
+        }
+        out.push_back(static_cast<char>(type | info));
+        for (int i = bytes - 1; i >= 0; --i) {
+            out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+        }
+    }
+
+    inline void append_string(std::string& out, const std::string& str)
+    {
+        append_head(out, 3, str.size());
+        out.append(str);
+    }
+
+    inline void append_integer(std::string& out, long long value)
+    {
+        if (value >= 0) {
+            append_head(out, 0, static_cast<uint64_t>(value));
+        }
+        else {
+            append_head(out, 1, static_cast<uint64_t>(-(value + 1)));
+        }
+    }
+
+    inline void append_double(std::string& out, double value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        out.push_back(static_cast<char>(0xfb));
+        for (int i = 7; i >= 0; --i) {
+            out.push_back(static_cast<char>((bits >> (i * 8)) & 0xff));
+        }
+    }
+
+    inline void append(std::string& out, const json::value& value)
+    {
+        using value_type = json::value::value_type;
+
+        switch (value.type()) {
+        case value_type::null:
+            out.push_back(static_cast<char>(0xf6));
+            break;
+        case value_type::boolean:
+            out.push_back(static_cast<char>(value.as_boolean() ? 0xf5 : 0xf4));
+            break;
+        case value_type::string:
+            append_string(out, value.as_string());
+            break;
+        case value_type::number: {
+            // meojson 内部以原始文本保存数字，没有小数点和指数的按整数编码
+            // 不能完整解析为 long long 的（超出范围、inf、nan 等）都按浮点数编码
+            const std::string raw = value.to_string();
+            if (raw.find_first_of(".eE") == std::string::npos) {
+                long long integer = 0;
+                const char* end = raw.data() + raw.size();
+                auto [ptr, ec] = std::from_chars(raw.data(), end, integer);
+                if (ec == std::errc() && ptr == end) {
+                    append_integer(out, integer);
+                    break;
+                }
+            }
+            append_double(out, value.as_double());
+            break;
+        }
+        case value_type::array: {
+            const auto& array = value.as_array();
+            append_head(out, 4, array.size());
+            for (const auto& item : array) {
+                append(out, item);
+            }
+            break;
+        }
+        case value_type::object: {
+            const auto& object = value.as_object();
+            append_head(out, 5, object.size());
+            for (const auto& [key, item] : object) {
+                append_string(out, key);
+                append(out, item);
+            }
+            break;
+        }
+        default:
+            // undefined
+            out.push_back(static_cast<char>(0xf7));
+            break;
+        }
+    }
+} // namespace asst::utils::cbor
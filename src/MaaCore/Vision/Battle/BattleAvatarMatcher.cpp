@@ -0,0 +1,95 @@
+#include "BattleAvatarMatcher.h"
+
+#include <numeric>
+
+#include "Utils/NoWarningCV.h"
+
+#include "Utils/Logger.hpp"
+#include "Vision/Matcher.h"
+
+using namespace asst;
+
+BattleAvatarMatcher::ResultOpt BattleAvatarMatcher::analyze() const
+{
+    if (m_index.names.empty()) {
+        return std::nullopt;
+    }
+
+    const cv::Mat image = make_roi(m_image, m_roi);
+    const auto candidates = shortlist(image);
+
+    // 各候选的完整匹配互不相关，并行计算
+    std::vector<double> scores(candidates.size(), 0.0);
+    std::vector<Rect> rects(candidates.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(candidates.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            auto params = m_params;
+            params.templs = { m_index.avatars[candidates[i]] };
+
+            const auto match_results = Matcher::preproc_and_match(image, params);
+            if (match_results.empty() || match_results.front().matched.empty()) {
+                continue;
+            }
+            const auto& [matched, templ, _] = match_results.front();
+
+            double max_val = 0.0;
+            cv::Point max_loc;
+            cv::minMaxLoc(matched, nullptr, &max_val, nullptr, &max_loc);
+            if (std::isnan(max_val) || std::isinf(max_val)) {
+                max_val = 0;
+            }
+            scores[i] = max_val;
+            rects[i] = Rect(max_loc.x + m_roi.x, max_loc.y + m_roi.y, templ.cols, templ.rows);
+        }
+    });
+
+    const double threshold = m_params.templ_thres.empty() ? 0.0 : m_params.templ_thres.front();
+    Result result;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (scores[i] < threshold || scores[i] <= result.score) {
+            continue;
+        }
+        const size_t index = candidates[i];
+        result = Result { .rect = rects[i],
+                          .score = scores[i],
+                          .templ_info = { .name = m_index.names[index], .templ = m_index.avatars[index] } };
+    }
+
+    if (!result.score) {
+        return std::nullopt;
+    }
+
+    if (m_log_tracing) {
+        Log.trace("The best match is", result.to_string(), "candidates:", candidates.size(), "/",
+                  m_index.names.size());
+    }
+    m_result = std::move(result);
+    return m_result;
+}
+
+std::vector<size_t> BattleAvatarMatcher::shortlist(const cv::Mat& image) const
+{
+    const size_t total = m_index.names.size();
+    std::vector<size_t> candidates(total);
+    std::iota(candidates.begin(), candidates.end(), 0);
+    if (total <= MaxCandidates) {
+        return candidates;
+    }
+
+    const cv::Mat feature = AvatarCacheManager::calc_feature(image);
+    if (feature.cols != m_index.features.cols) {
+        Log.error(__FUNCTION__, "feature size mismatch", feature.cols, m_index.features.cols);
+        return candidates;
+    }
+    // 一次矩阵乘法得到所有头像的粗筛得分
+    cv::Mat coarse_scores;
+    cv::gemm(m_index.features, feature, 1.0, cv::noArray(), 0.0, coarse_scores, cv::GEMM_2_T);
+
+    std::partial_sort(candidates.begin(), candidates.begin() + MaxCandidates, candidates.end(),
+                      [&](size_t lhs, size_t rhs) {
+                          return coarse_scores.at<float>(static_cast<int>(lhs)) >
+                                 coarse_scores.at<float>(static_cast<int>(rhs));
+                      });
+    candidates.resize(MaxCandidates);
+    return candidates;
+}
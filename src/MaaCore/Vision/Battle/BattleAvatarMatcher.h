@@ -0,0 +1,42 @@
+#pragma once
+#include "Vision/VisionHelper.h"
+
+#include "Config/Miscellaneous/AvatarCacheManager.h"
+#include "Vision/BestMatcher.h"
+#include "Vision/Config/MatcherConfig.h"
+
+namespace asst
+{
+    // 用 AvatarCacheManager 的头像索引识别部署栏干员：先用缩小图特征粗筛，再对候选做完整的模板匹配
+    // 结果与把所有头像都加入 BestMatcher 一致（除非正确答案没进粗筛的候选）
+    class BattleAvatarMatcher : public VisionHelper, public MatcherConfig
+    {
+    public:
+        using Result = BestMatcher::Result;
+        using ResultOpt = std::optional<Result>;
+
+        static constexpr size_t MaxCandidates = 16;
+
+    public:
+        using VisionHelper::VisionHelper;
+        virtual ~BattleAvatarMatcher() override = default;
+
+        void set_index(AvatarCacheManager::AvatarIndex index) { m_index = std::move(index); }
+
+        ResultOpt analyze() const;
+        // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
+        const auto& get_result() const { return m_result; }
+
+    protected:
+        virtual void _set_roi(const Rect& roi) override { set_roi(roi); }
+
+        std::vector<size_t> shortlist(const cv::Mat& image) const;
+
+    private:
+        using MatcherConfig::set_templ;
+
+        AvatarCacheManager::AvatarIndex m_index;
+        // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
+        mutable Result m_result;
+    };
+}
@@ -4,12 +4,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <map>
 
 
 #include "Config/OnnxSessions.h"
 #include "Config/TaskData.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
 
 using namespace asst;
 
@@ -61,7 +65,10 @@ BattlefieldClassifier::SkillReadyResult BattlefieldClassifier::skill_ready_analy
     constexpr const char* output_names[] = { "output" }; // session.GetOutputName()
 
     Ort::RunOptions run_options;
-    session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    {
+        PerfStats::Scope perf_scope(PerfStats::Category::Inference, "skill_ready_cls");
+        session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    }
     Log.info(__FUNCTION__, "raw results:", raw_results);
 
     SkillReadyResult::Prob prob = softmax(raw_results);
@@ -88,25 +95,123 @@ BattlefieldClassifier::SkillReadyResult BattlefieldClassifier::skill_ready_analy
 }
 
 BattlefieldClassifier::DeployDirectionResult BattlefieldClassifier::deploy_direction_analyze() const
+{
+    Rect roi = deploy_direction_roi(m_base_point);
+    cv::Mat image = make_roi(m_image, correct_rect(roi, m_image));
+
+    DeployDirectionResult result = make_deploy_direction_result(deploy_direction_inference({ image }).front(), roi,
+                                                                m_base_point);
+
+#ifdef ASST_DEBUG
+    static const std::unordered_map<size_t, std::string> ClassNames = {
+        { 0, "Right" },
+        { 1, "Down" },
+        { 2, "Left" },
+        { 3, "Up" },
+    };
+    if (ClassNames.size() != result.prob.size()) {
+        Log.error("ClassNames.size() != prob.size()", ClassNames.size(), result.prob.size());
+        throw std::runtime_error("ClassNames.size() != prob.size()");
+    }
+    size_t class_id = static_cast<size_t>(result.direction);
+    cv::putText(m_image_draw, ClassNames.at(class_id), cv::Point(roi.x, roi.y + roi.height), cv::FONT_HERSHEY_PLAIN,
+                1.2, cv::Scalar(0, 255, 0), 2);
+    cv::putText(m_image_draw, std::to_string(result.score), cv::Point(roi.x, roi.y + roi.height + 20),
+                cv::FONT_HERSHEY_PLAIN, 1.2, cv::Scalar(0, 255, 0), 2);
+#endif
+
+    return result;
+}
+
+std::vector<BattlefieldClassifier::DeployDirectionResult>
+    BattlefieldClassifier::deploy_direction_analyze_batch(const std::vector<DeployDirectionQuery>& queries)
+{
+    LogTraceFunction;
+
+    std::vector<DeployDirectionResult> results(queries.size());
+
+    // 靠近画面边缘的 roi 会被裁剪，只有尺寸相同的才能拼到同一个 batch 里
+    struct Group
+    {
+        std::vector<size_t> indices;
+        std::vector<Rect> rois;
+        std::vector<cv::Mat> images;
+    };
+    std::map<std::pair<int, int>, Group> groups;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const DeployDirectionQuery& query = queries[i];
+        Rect roi = deploy_direction_roi(query.base_point);
+        cv::Mat image = make_roi(query.image, correct_rect(roi, query.image));
+        Group& group = groups[{ image.cols, image.rows }];
+        group.indices.emplace_back(i);
+        group.rois.emplace_back(roi);
+        group.images.emplace_back(std::move(image));
+    }
+
+    for (const Group& group : groups | views::values) {
+        for (size_t begin = 0; begin < group.images.size(); begin += DeployDirectionMaxBatchSize) {
+            const size_t end = std::min(begin + DeployDirectionMaxBatchSize, group.images.size());
+            std::vector<cv::Mat> images(group.images.begin() + begin, group.images.begin() + end);
+            std::vector<DeployDirectionResult::Raw> raws = deploy_direction_inference(images);
+            for (size_t i = begin; i < end; ++i) {
+                const size_t index = group.indices[i];
+                results[index] = make_deploy_direction_result(raws[i - begin], group.rois[i], queries[index].base_point);
+            }
+        }
+    }
+    return results;
+}
+
+Rect BattlefieldClassifier::deploy_direction_roi(const Point& base_point)
 {
     const auto& task_ptr = Task.get<MatchTaskInfo>("BattleDeployDirectionRectMove");
     const Rect& roi_move = task_ptr->rect_move;
-    Rect roi = Rect(m_base_point.x, m_base_point.y, 0, 0).move(roi_move);
+    return Rect(base_point.x, base_point.y, 0, 0).move(roi_move);
+}
 
-    cv::Mat image = make_roi(m_image, correct_rect(roi, m_image));
-    std::vector<float> input = image_to_tensor(image);
+std::vector<BattlefieldClassifier::DeployDirectionResult::Raw>
+    BattlefieldClassifier::deploy_direction_inference(const std::vector<cv::Mat>& images)
+{
+    if (images.empty()) {
+        return {};
+    }
+
+    // 模型若不支持动态 batch，退化为逐张推理
+    static std::atomic_bool batch_supported = true;
+    if (images.size() > 1 && !batch_supported) {
+        std::vector<DeployDirectionResult::Raw> raw_results;
+        raw_results.reserve(images.size());
+        for (const cv::Mat& image : images) {
+            raw_results.emplace_back(deploy_direction_inference({ image }).front());
+        }
+        return raw_results;
+    }
+
+    const cv::Mat& first = images.front();
+    const size_t image_size = 1ULL * first.channels() * first.cols * first.rows;
+
+    // 输入输出缓冲区在同一线程的多次调用间复用
+    thread_local std::vector<float> input;
+    thread_local std::vector<DeployDirectionResult::Raw> raw_results;
+    input.resize(image_size * images.size());
+    raw_results.resize(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        std::vector<float> tensor = image_to_tensor(images[i]);
+        std::copy(tensor.begin(), tensor.end(), input.begin() + static_cast<std::ptrdiff_t>(i * image_size));
+    }
 
     auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
-    constexpr int64_t batch_size = 1;
-    std::array<int64_t, 4> input_shape { batch_size, image.channels(), image.cols, image.rows };
+    const int64_t batch_size = static_cast<int64_t>(images.size());
+    std::array<int64_t, 4> input_shape { batch_size, first.channels(), first.cols, first.rows };
 
     Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input.data(), input.size(),
                                                               input_shape.data(), input_shape.size());
 
-    DeployDirectionResult::Raw raw_results;
     std::array<int64_t, 2> output_shape { batch_size, DeployDirectionResult::ClsSize };
-    Ort::Value output_tensor = Ort::Value::CreateTensor<float>(memory_info, raw_results.data(), raw_results.size(),
-                                                               output_shape.data(), output_shape.size());
+    Ort::Value output_tensor =
+        Ort::Value::CreateTensor<float>(memory_info, raw_results.front().data(),
+                                        raw_results.size() * DeployDirectionResult::ClsSize, output_shape.data(),
+                                        output_shape.size());
 
     auto& session = OnnxSessions::get_instance().get("deploy_direction_cls");
     // 这俩是hardcode在模型里的
@@ -114,37 +219,37 @@ BattlefieldClassifier::DeployDirectionResult BattlefieldClassifier::deploy_direc
     constexpr const char* output_names[] = { "output" }; // session.GetOutputName()
 
     Ort::RunOptions run_options;
-    session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
-    Log.info(__FUNCTION__, "raw result:", raw_results);
+    try {
+        PerfStats::Scope perf_scope(PerfStats::Category::Inference, "deploy_direction_cls");
+        session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    }
+    catch (const Ort::Exception& e) {
+        if (images.size() == 1) {
+            throw;
+        }
+        Log.warn(__FUNCTION__, "batch inference failed, fallback to single:", e.what());
+        batch_supported = false;
+        return deploy_direction_inference(images);
+    }
+    Log.info(__FUNCTION__, "batch size:", batch_size, ", raw results:", raw_results);
+
+    return raw_results;
+}
 
+BattlefieldClassifier::DeployDirectionResult BattlefieldClassifier::make_deploy_direction_result(
+    const DeployDirectionResult::Raw& raw_results, const Rect& roi, const Point& base_point)
+{
     DeployDirectionResult::Prob prob = softmax(raw_results);
     Log.info(__FUNCTION__, "after softmax:", prob);
 
     size_t class_id = std::max_element(prob.begin(), prob.end()) - prob.begin();
 
-#ifdef ASST_DEBUG
-    static const std::unordered_map<size_t, std::string> ClassNames = {
-        { 0, "Right" },
-        { 1, "Down" },
-        { 2, "Left" },
-        { 3, "Up" },
-    };
-    if (ClassNames.size() != prob.size()) {
-        Log.error("ClassNames.size() != prob.size()", ClassNames.size(), prob.size());
-        throw std::runtime_error("ClassNames.size() != prob.size()");
-    }
-    cv::putText(m_image_draw, ClassNames.at(class_id), cv::Point(roi.x, roi.y + roi.height), cv::FONT_HERSHEY_PLAIN,
-                1.2, cv::Scalar(0, 255, 0), 2);
-    cv::putText(m_image_draw, std::to_string(prob[class_id]), cv::Point(roi.x, roi.y + roi.height + 20),
-                cv::FONT_HERSHEY_PLAIN, 1.2, cv::Scalar(0, 255, 0), 2);
-#endif
-
     return DeployDirectionResult {
         .direction = static_cast<battle::DeployDirection>(class_id),
         .rect = roi,
         .score = prob[class_id],
         .raw = raw_results,
         .prob = prob,
-        .base_point = m_base_point,
+        .base_point = base_point,
     };
 }
@@ -56,6 +56,12 @@ namespace asst
 
         using ResultOpt = std::optional<Result>;
 
+        struct DeployDirectionQuery
+        {
+            cv::Mat image;
+            Point base_point;
+        };
+
     public:
         using VisionHelper::VisionHelper;
         virtual ~BattlefieldClassifier() override = default;
@@ -65,10 +71,22 @@ namespace asst
 
         ResultOpt analyze() const;
 
+        // 一次推理识别多张图、多个位置的部署朝向，结果与 queries 一一对应
+        static std::vector<DeployDirectionResult>
+            deploy_direction_analyze_batch(const std::vector<DeployDirectionQuery>& queries);
+
     protected:
         SkillReadyResult skill_ready_analyze() const;
         DeployDirectionResult deploy_direction_analyze() const;
 
+        static Rect deploy_direction_roi(const Point& base_point);
+        // images 的尺寸必须相同
+        static std::vector<DeployDirectionResult::Raw> deploy_direction_inference(const std::vector<cv::Mat>& images);
+        static DeployDirectionResult make_deploy_direction_result(const DeployDirectionResult::Raw& raw_results,
+                                                                  const Rect& roi, const Point& base_point);
+
+        static constexpr size_t DeployDirectionMaxBatchSize = 64;
+
         ObjectOfInterest m_object_of_interest; // 待识别的目标
         Point m_base_point;
     };
@@ -9,6 +9,7 @@
 #include "Config/Miscellaneous/TilePack.h"
 #include "Config/OnnxSessions.h"
 #include "Config/TaskData.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 
 using namespace asst;
@@ -34,16 +35,32 @@ BattlefieldDetector::ResultOpt BattlefieldDetector::analyze() const
 
 std::vector<BattlefieldDetector::OperatorResult> BattlefieldDetector::operator_analyze() const
 {
-    const double x_scale = 640.0 / m_image.cols;
-    const double y_scale = 640.0 / m_image.rows;
-
-    cv::Mat image;
-    cv::resize(m_image, image, cv::Size(), x_scale, y_scale, cv::INTER_AREA);
-    std::vector<float> input = image_to_tensor(image);
+    constexpr int InputSize = 640;
+    const double x_scale = static_cast<double>(InputSize) / m_image.cols;
+    const double y_scale = static_cast<double>(InputSize) / m_image.rows;
+
+    // 直接把缩放后的图像按 RGB 平面写进输入张量，省掉 image_to_tensor 里的多次拷贝
+    thread_local std::vector<float> input;
+    input.resize(3ULL * InputSize * InputSize);
+    {
+        cv::Mat image;
+        cv::resize(m_image, image, cv::Size(InputSize, InputSize), 0, 0, cv::INTER_AREA);
+        cv::Mat image_32f;
+        image.convertTo(image_32f, CV_32F, 1.0 / 255.0);
+
+        const size_t plane_size = 1ULL * InputSize * InputSize;
+        // BGR -> RGB
+        std::vector<cv::Mat> planes = {
+            cv::Mat(InputSize, InputSize, CV_32F, input.data() + 2 * plane_size),
+            cv::Mat(InputSize, InputSize, CV_32F, input.data() + plane_size),
+            cv::Mat(InputSize, InputSize, CV_32F, input.data()),
+        };
+        cv::split(image_32f, planes);
+    }
 
     auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
     constexpr int64_t batch_size = 1;
-    std::array<int64_t, 4> input_shape { batch_size, image.channels(), image.cols, image.rows };
+    std::array<int64_t, 4> input_shape { batch_size, 3, InputSize, InputSize };
 
     Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input.data(), input.size(),
                                                               input_shape.data(), input_shape.size());
@@ -57,8 +74,12 @@ std::vector<BattlefieldDetector::OperatorResult> BattlefieldDetector::operator_a
     std::vector output_names = { output_name.c_str() };
 
     Ort::RunOptions run_options;
-    auto output_tensors = session.Run(run_options, input_names.data(), &input_tensor, input_names.size(),
-                                      output_names.data(), output_names.size());
+    std::vector<Ort::Value> output_tensors;
+    {
+        PerfStats::Scope perf_scope(PerfStats::Category::Inference, "operators_det");
+        output_tensors = session.Run(run_options, input_names.data(), &input_tensor, input_names.size(),
+                                     output_names.data(), output_names.size());
+    }
 
     const float* raw_output = output_tensors[0].GetTensorData<float>();
     // output_shape is { 1, 5, 8400 }
@@ -72,10 +93,22 @@ std::vector<BattlefieldDetector::OperatorResult> BattlefieldDetector::operator_a
     // h0, h1, ..... h8399
     // conf0, conf1, ..... conf8399
     // 如果后面要做多分类，可能得再看下怎么改（我也不知道shape会变成啥样）
-    std::vector<std::vector<float>> output(output_shape[1]);
-    for (int64_t i = 0; i < output_shape[1]; i++) {
-        output[i] = std::vector<float>(raw_output + i * output_shape[2], raw_output + (i + 1) * output_shape[2]);
-    }
+    // 直接在输出张量上按行取指针，不再拷贝
+    const int rows = static_cast<int>(output_shape[1]);
+    const int anchors = static_cast<int>(output_shape[2]);
+    auto output_row = [&](int row) { return raw_output + static_cast<size_t>(row) * anchors; };
+    const float* center_x_row = output_row(0);
+    const float* center_y_row = output_row(1);
+    const float* w_row = output_row(2);
+    const float* h_row = output_row(3);
+
+    // 置信度过滤交给 OpenCV 的向量化比较
+    constexpr float Threshold = 0.3f;
+    const cv::Mat conf_row(1, anchors, CV_32F, const_cast<float*>(output_row(rows - 1)));
+    cv::Mat conf_mask;
+    cv::compare(conf_row, Threshold, conf_mask, cv::CMP_GE);
+    std::vector<cv::Point> candidates;
+    cv::findNonZero(conf_mask, candidates);
 
 #ifdef ASST_DEBUG
 
@@ -85,18 +118,15 @@ std::vector<BattlefieldDetector::OperatorResult> BattlefieldDetector::operator_a
 #endif
 
     std::vector<OperatorResult> all_results;
-    const auto& conf_vec = output.back();
-    for (size_t i = 0; i < conf_vec.size(); ++i) {
-        float score = conf_vec[i];
-        constexpr float Threshold = 0.3f;
-        if (score < Threshold) {
-            continue;
-        }
-
-        int center_x = static_cast<int>(output[0][i] / x_scale);
-        int center_y = static_cast<int>(output[1][i] / y_scale);
-        int w = static_cast<int>(output[2][i] / x_scale);
-        int h = static_cast<int>(output[3][i] / y_scale);
+    all_results.reserve(candidates.size());
+    for (const cv::Point& candidate : candidates) {
+        const int i = candidate.x;
+        float score = conf_row.at<float>(i);
+
+        int center_x = static_cast<int>(center_x_row[i] / x_scale);
+        int center_y = static_cast<int>(center_y_row[i] / y_scale);
+        int w = static_cast<int>(w_row[i] / x_scale);
+        int h = static_cast<int>(h_row[i] / y_scale);
 
         int x = center_x - w / 2;
         int y = center_y - h / 2;
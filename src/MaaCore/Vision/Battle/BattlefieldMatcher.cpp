@@ -70,8 +70,13 @@ BattlefieldMatcher::ResultOpt BattlefieldMatcher::analyze() const
 
 std::vector<battle::DeploymentOper> BattlefieldMatcher::deployment_analyze() const
 {
-    MultiMatcher flags_analyzer(m_image);
     const auto& flag_task_ptr = Task.get("BattleOpersFlag");
+    const Rect bar_roi = correct_rect(flag_task_ptr->roi, m_image);
+    if (auto cached_opt = deployment_from_cache(bar_roi)) {
+        return std::move(cached_opt).value();
+    }
+
+    MultiMatcher flags_analyzer(m_image);
     flags_analyzer.set_task_info(flag_task_ptr);
 
 #ifndef ASST_DEBUG
@@ -80,73 +85,191 @@ std::vector<battle::DeploymentOper> BattlefieldMatcher::deployment_analyze() con
 
     auto flag_opt = flags_analyzer.analyze();
     if (!flag_opt) {
+        if (m_deployment_cache) {
+            *m_deployment_cache = DeploymentCache {};
+        }
         return {};
     }
     auto& flags = flag_opt.value();
     sort_by_horizontal_(flags);
 
     const Rect& click_move = Task.get("BattleOperClickRange")->rect_move;
-    const Rect& role_move = Task.get("BattleOperRoleRange")->rect_move;
-    const Rect& avlb_move = Task.get("BattleOperAvailable")->rect_move;
-    const Rect& cooling_move = Task.get("BattleOperCooling")->rect_move;
     const Rect& avatar_move = Task.get("BattleOperAvatar")->rect_move;
     const Rect& cost_move = Task.get("BattleOperCost")->rect_move;
 
+    std::vector<DeploymentCache::Card> cards;
+    std::vector<bool> cached_used(m_deployment_cache ? m_deployment_cache->cards.size() : 0, false);
+
     std::vector<battle::DeploymentOper> oper_result;
     size_t index = 0;
     for (const auto& flag_res : flags) {
-        battle::DeploymentOper oper;
-        oper.rect = flag_res.rect.move(click_move);
-
-        Rect role_rect = flag_res.rect.move(role_move);
-        oper.role = oper_role_analyze(role_rect);
-        if (oper.role == battle::Role::Unknown) {
-            Log.warn("Unknown role");
-            continue;
+        DeploymentCache::Card card;
+        card.rect = oper_card_rect(flag_res.rect);
+
+        // 部署/撤退后卡片会整体平移，所以不按位置而是按图像找上次的同一张卡
+        bool reused = false;
+        if (m_deployment_cache) {
+            card.patch = m_image(make_rect<cv::Rect>(card.rect)).clone();
+            const auto& cached_cards = m_deployment_cache->cards;
+            for (size_t i = 0; i < cached_cards.size(); ++i) {
+                const auto& cached = cached_cards[i];
+                if (cached_used[i] || cached.patch.size() != card.patch.size() ||
+                    cv::norm(cached.patch, card.patch, cv::NORM_INF) > DeploymentDiffThreshold) {
+                    continue;
+                }
+                cached_used[i] = true;
+                card.oper = cached.oper;
+                card.with_cost = cached.with_cost;
+                reused = true;
+                break;
+            }
+        }
+        if (reused) {
+            card.oper.rect = flag_res.rect.move(click_move);
+            if (card.oper.rect.x + card.oper.rect.width >= m_image.cols) {
+                card.oper.rect.width = m_image.cols - card.oper.rect.x;
+            }
+        }
+        else {
+            auto oper_opt = oper_analyze(flag_res.rect);
+            if (!oper_opt) {
+                continue;
+            }
+            card.oper = std::move(oper_opt).value();
+            card.with_cost = m_object_of_interest.oper_cost;
         }
 
-        if (oper.rect.x + oper.rect.width >= m_image.cols) {
-            oper.rect.width = m_image.cols - oper.rect.x;
+        if (m_object_of_interest.oper_cost && !card.with_cost) {
+            Rect cost_rect = correct_rect(flag_res.rect.move(cost_move), m_image);
+            card.oper.cost = oper_cost_analyze(cost_rect);
+            card.with_cost = true;
         }
+        card.oper.index = index++;
+
+        battle::DeploymentOper oper = card.oper;
         Rect avatar_rect = oper.rect.move(avatar_move);
         oper.avatar = m_image(make_rect<cv::Rect>(avatar_rect));
+        oper_result.emplace_back(std::move(oper));
 
-        Rect available_rect = flag_res.rect.move(avlb_move);
-        oper.available = oper_available_analyze(available_rect);
-
-#ifdef ASST_DEBUG
-        if (oper.available) {
-            cv::rectangle(m_image_draw, make_rect<cv::Rect>(oper.rect), cv::Scalar(0, 255, 0), 2);
+        if (m_deployment_cache) {
+            cards.emplace_back(std::move(card));
         }
-        else {
-            cv::rectangle(m_image_draw, make_rect<cv::Rect>(oper.rect), cv::Scalar(0, 0, 255), 2);
+    }
+
+    if (m_deployment_cache) {
+        m_deployment_cache->bar_patch = m_image(make_rect<cv::Rect>(bar_roi)).clone();
+        m_deployment_cache->cards = std::move(cards);
+    }
+
+    return oper_result;
+}
+
+std::optional<std::vector<battle::DeploymentOper>> BattlefieldMatcher::deployment_from_cache(const Rect& bar_roi) const
+{
+    if (!m_deployment_cache || m_deployment_cache->cards.empty()) {
+        return std::nullopt;
+    }
+
+    auto unchanged = [&](const Rect& rect, const cv::Mat& patch) {
+        if (patch.cols != rect.width || patch.rows != rect.height) {
+            return false;
         }
-#endif
+        return cv::norm(m_image(make_rect<cv::Rect>(rect)), patch, cv::NORM_INF) <= DeploymentDiffThreshold;
+    };
 
-        Rect cooling_rect = correct_rect(flag_res.rect.move(cooling_move), m_image);
-        oper.cooling = oper_cooling_analyze(cooling_rect);
-        if (oper.cooling && oper.available) {
-            Log.error("oper is available, but with cooling");
+    // 整个部署栏和每张卡片都没变化时，连 flag 的模板匹配都不用做
+    if (!unchanged(bar_roi, m_deployment_cache->bar_patch)) {
+        return std::nullopt;
+    }
+    for (const auto& card : m_deployment_cache->cards) {
+        if (!unchanged(card.rect, card.patch)) {
+            return std::nullopt;
         }
+        if (m_object_of_interest.oper_cost && !card.with_cost) {
+            return std::nullopt;
+        }
+    }
+
+    const Rect& avatar_move = Task.get("BattleOperAvatar")->rect_move;
+    std::vector<battle::DeploymentOper> oper_result;
+    oper_result.reserve(m_deployment_cache->cards.size());
+    for (const auto& card : m_deployment_cache->cards) {
+        battle::DeploymentOper oper = card.oper;
+        Rect avatar_rect = oper.rect.move(avatar_move);
+        oper.avatar = m_image(make_rect<cv::Rect>(avatar_rect));
+        oper_result.emplace_back(std::move(oper));
+    }
+    return oper_result;
+}
+
+std::optional<battle::DeploymentOper> BattlefieldMatcher::oper_analyze(const Rect& flag_rect) const
+{
+    const Rect& click_move = Task.get("BattleOperClickRange")->rect_move;
+    const Rect& role_move = Task.get("BattleOperRoleRange")->rect_move;
+    const Rect& avlb_move = Task.get("BattleOperAvailable")->rect_move;
+    const Rect& cooling_move = Task.get("BattleOperCooling")->rect_move;
+    const Rect& cost_move = Task.get("BattleOperCost")->rect_move;
+
+    battle::DeploymentOper oper;
+    oper.rect = flag_rect.move(click_move);
+
+    Rect role_rect = flag_rect.move(role_move);
+    oper.role = oper_role_analyze(role_rect);
+    if (oper.role == battle::Role::Unknown) {
+        Log.warn("Unknown role");
+        return std::nullopt;
+    }
+
+    if (oper.rect.x + oper.rect.width >= m_image.cols) {
+        oper.rect.width = m_image.cols - oper.rect.x;
+    }
+
+    Rect available_rect = flag_rect.move(avlb_move);
+    oper.available = oper_available_analyze(available_rect);
 
 #ifdef ASST_DEBUG
-        if (oper.cooling) {
-            cv::putText(m_image_draw, "cooling", cv::Point(oper.rect.x, oper.rect.y - 20), 1, 1.2,
-                        cv::Scalar(0, 0, 255));
-        }
+    if (oper.available) {
+        cv::rectangle(m_image_draw, make_rect<cv::Rect>(oper.rect), cv::Scalar(0, 255, 0), 2);
+    }
+    else {
+        cv::rectangle(m_image_draw, make_rect<cv::Rect>(oper.rect), cv::Scalar(0, 0, 255), 2);
+    }
 #endif
 
-        if (m_object_of_interest.oper_cost) {
-            Rect cost_rect = correct_rect(flag_res.rect.move(cost_move), m_image);
-            oper.cost = oper_cost_analyze(cost_rect);
-        }
+    Rect cooling_rect = correct_rect(flag_rect.move(cooling_move), m_image);
+    oper.cooling = oper_cooling_analyze(cooling_rect);
+    if (oper.cooling && oper.available) {
+        Log.error("oper is available, but with cooling");
+    }
 
-        oper.index = index++;
+#ifdef ASST_DEBUG
+    if (oper.cooling) {
+        cv::putText(m_image_draw, "cooling", cv::Point(oper.rect.x, oper.rect.y - 20), 1, 1.2, cv::Scalar(0, 0, 255));
+    }
+#endif
 
-        oper_result.emplace_back(std::move(oper));
+    if (m_object_of_interest.oper_cost) {
+        Rect cost_rect = correct_rect(flag_rect.move(cost_move), m_image);
+        oper.cost = oper_cost_analyze(cost_rect);
     }
 
-    return oper_result;
+    return oper;
+}
+
+Rect BattlefieldMatcher::oper_card_rect(const Rect& flag_rect) const
+{
+    static const std::vector<std::string> MoveTasks = {
+        "BattleOperClickRange", "BattleOperRoleRange", "BattleOperAvailable",
+        "BattleOperCooling",    "BattleOperCost",
+    };
+    const Rect& avatar_move = Task.get("BattleOperAvatar")->rect_move;
+    const Rect& click_move = Task.get("BattleOperClickRange")->rect_move;
+
+    cv::Rect card = make_rect<cv::Rect>(flag_rect.move(click_move).move(avatar_move));
+    for (const auto& task_name : MoveTasks) {
+        card |= make_rect<cv::Rect>(flag_rect.move(Task.get(task_name)->rect_move));
+    }
+    return correct_rect(make_rect<Rect>(card), m_image);
 }
 
 battle::Role BattlefieldMatcher::oper_role_analyze(const Rect& roi) const
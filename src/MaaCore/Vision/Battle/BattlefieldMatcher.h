@@ -35,12 +35,30 @@ namespace asst
 
         using ResultOpt = std::optional<Result>;
 
+        // 部署栏增量识别的缓存，由调用者持有并在多次 analyze 间复用
+        // 卡片区域的像素没变化的，直接沿用上次的职业、可用、冷却、费用识别结果
+        struct DeploymentCache
+        {
+            struct Card
+            {
+                Rect rect;                   // 卡片区域（包含职业、头像、可用、冷却、费用等识别区域）
+                cv::Mat patch;               // 卡片区域的图像
+                battle::DeploymentOper oper; // avatar 为空
+                bool with_cost = false;      // oper.cost 是否识别过
+            };
+            cv::Mat bar_patch; // 整个部署栏 flag 识别区域的图像
+            std::vector<Card> cards;
+        };
+        // 像素差异（各通道最大绝对差）不超过该值的区域视为没有变化
+        static constexpr double DeploymentDiffThreshold = 16.0;
+
     public:
         using VisionHelper::VisionHelper;
         virtual ~BattlefieldMatcher() override = default;
 
         void set_object_of_interest(ObjectOfInterest obj);
         void set_total_kills_prompt(int prompt);
+        void set_deployment_cache(DeploymentCache* cache) noexcept { m_deployment_cache = cache; }
 
         ResultOpt analyze() const;
 
@@ -50,6 +68,9 @@ namespace asst
         bool pause_button_analyze() const;
 
         std::vector<battle::DeploymentOper> deployment_analyze() const; // 识别干员
+        std::optional<std::vector<battle::DeploymentOper>> deployment_from_cache(const Rect& bar_roi) const;
+        std::optional<battle::DeploymentOper> oper_analyze(const Rect& flag_rect) const;
+        Rect oper_card_rect(const Rect& flag_rect) const;
         battle::Role oper_role_analyze(const Rect& roi) const;
         bool oper_cooling_analyze(const Rect& roi) const;
         int oper_cost_analyze(const Rect& roi) const;
@@ -62,5 +83,6 @@ namespace asst
 
         ObjectOfInterest m_object_of_interest; // 待识别的目标
         int m_total_kills_prompt = 0; // 之前的击杀总数，因为击杀数经常识别不准所以依赖外部传入作为参考
+        DeploymentCache* m_deployment_cache = nullptr;
     };
 } // namespace asst
@@ -5,6 +5,7 @@
 #include "Config/TaskData.h"
 #include "Config/TemplResource.h"
 #include "Matcher.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 #include "Utils/StringMisc.hpp"
 
@@ -17,32 +18,81 @@ void BestMatcher::append_templ(std::string name, const cv::Mat& templ)
 
 BestMatcher::ResultOpt BestMatcher::analyze() const
 {
-    Matcher match_analyzer(m_image, m_roi);
-    match_analyzer.set_params(m_params);
-#ifdef ASST_DEBUG
-    match_analyzer.set_log_tracing(m_log_tracing);
-#else
-    match_analyzer.set_log_tracing(false);
-#endif
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "BestMatcher");
 
-    Result result;
-    for (const auto& templ_info : m_templs) {
-        auto&& [name, templ] = templ_info;
+    const cv::Mat image = make_roi(m_image, m_roi);
+    const double threshold = m_params.templ_thres.empty() ? 0.0 : m_params.templ_thres.front();
+    const MatchMethod method = m_params.methods.empty() ? MatchMethod::Ccoeff : m_params.methods.front();
 
+    // 先取出所有模板：TemplResource 不是线程安全的，不能放到匹配线程里懒加载
+    // 空的或比原图还大的模板直接跳过，否则 preproc_and_match 会整批失败
+    std::vector<const TemplInfo*> templ_infos;
+    MatcherConfig::Params params = m_params;
+    params.templs.clear();
+    templ_infos.reserve(m_templs.size());
+    params.templs.reserve(m_templs.size());
+    for (const auto& templ_info : m_templs) {
+        const cv::Mat& templ =
+            templ_info.templ.empty() ? TemplResource::get_instance().get_templ(templ_info.name) : templ_info.templ;
         if (templ.empty()) {
-            match_analyzer.set_templ(name);
+            Log.error("templ is empty!", templ_info.name);
+            continue;
         }
-        else {
-            match_analyzer.set_templ(templ);
+        if (templ.cols > image.cols || templ.rows > image.rows) {
+            Log.error("templ size is too large", templ_info.name, "image size:", image.cols, image.rows,
+                      "templ size:", templ.cols, templ.rows);
+            continue;
         }
+        templ_infos.emplace_back(&templ_info);
+        params.templs.emplace_back(templ);
+    }
+    params.templ_thres.assign(params.templs.size(), threshold);
+    params.methods.assign(params.templs.size(), method);
 
-        const auto& cur_opt = match_analyzer.analyze();
-        if (!cur_opt) {
-            continue;
+    // 原图的颜色转换在 preproc_and_match 中每批只做一次，并行时每块各做一次
+    std::vector<Result> results(templ_infos.size());
+    auto match_range = [&](size_t begin, size_t end) {
+        MatcherConfig::Params chunk_params = params;
+        chunk_params.templs.assign(params.templs.begin() + begin, params.templs.begin() + end);
+        chunk_params.templ_thres.resize(end - begin);
+        chunk_params.methods.resize(end - begin);
+
+        const auto raw_results = Matcher::preproc_and_match(image, chunk_params);
+        for (size_t i = 0; i < raw_results.size(); ++i) {
+            const auto& [matched, templ, _] = raw_results[i];
+            if (matched.empty()) {
+                continue;
+            }
+            double max_val = 0.0;
+            cv::Point max_loc;
+            cv::minMaxLoc(matched, nullptr, &max_val, nullptr, &max_loc);
+            if (std::isnan(max_val) || std::isinf(max_val)) {
+                max_val = 0;
+            }
+            Rect rect(max_loc.x + m_roi.x, max_loc.y + m_roi.y, templ.cols, templ.rows);
+            results[begin + i] = Result { .rect = rect, .score = max_val, .templ_info = *templ_infos[begin + i] };
         }
-        const auto& cur_matched = cur_opt.value();
-        if (result.score < cur_matched.score) {
-            result = Result { .rect = cur_matched.rect, .score = cur_matched.score, .templ_info = templ_info };
+    };
+
+    const size_t templ_count = templ_infos.size();
+    if (m_parallel && templ_count > ParallelChunkSize) {
+        const int chunk_count = static_cast<int>((templ_count + ParallelChunkSize - 1) / ParallelChunkSize);
+        cv::parallel_for_(cv::Range(0, chunk_count), [&](const cv::Range& range) {
+            for (int chunk = range.start; chunk < range.end; ++chunk) {
+                const size_t begin = chunk * ParallelChunkSize;
+                match_range(begin, (std::min)(begin + ParallelChunkSize, templ_count));
+            }
+        });
+    }
+    else {
+        match_range(0, templ_count);
+    }
+
+    // 与逐个匹配时一致：同分取先添加的
+    Result result;
+    for (const auto& cur : results) {
+        if (cur.score >= threshold && result.score < cur.score) {
+            result = cur;
         }
     }
 
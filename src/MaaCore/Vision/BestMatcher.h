@@ -34,6 +34,8 @@ namespace asst
         virtual ~BestMatcher() override = default;
 
         void append_templ(std::string name, const cv::Mat& templ = cv::Mat());
+        // 模板较多时分块多线程匹配
+        void set_parallel(bool parallel) noexcept { m_parallel = parallel; }
 
         ResultOpt analyze() const;
         // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
@@ -45,7 +47,10 @@ namespace asst
     private:
         using MatcherConfig::set_templ;
 
+        static constexpr size_t ParallelChunkSize = 16;
+
         std::vector<TemplInfo> m_templs;
+        bool m_parallel = false;
         // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
         mutable Result m_result;
     };
@@ -1,11 +1,16 @@
 #include "Hasher.h"
 
+#include <bit>
+
 #include "Utils/NoWarningCV.h"
 
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 
 bool asst::Hasher::analyze()
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "Hasher");
+
     m_hash_result.clear();
     m_min_dist_name.clear();
 
@@ -32,21 +37,12 @@ bool asst::Hasher::analyze()
         if (m_need_bound) {
             to_hash = bound_bin(to_hash);
         }
-        std::string hash_result = s_hash(to_hash);
-        // Log.debug(hash_result);
-
-        int min_dist = INT_MAX;
-        std::string cur_min_dist_name;
-        for (auto&& [name, templ] : m_hash_templates) {
-            int hm = hamming(hash_result, templ);
-            // Log.debug(name, "dist:", hm);
-            if (hm < min_dist) {
-                cur_min_dist_name = name;
-                min_dist = hm;
-            }
-        }
-        m_min_dist_name.emplace_back(std::move(cur_min_dist_name));
-        m_hash_result.emplace_back(std::move(hash_result));
+        HashValue hash_result = s_hash(to_hash);
+        // Log.debug(to_string(hash_result));
+
+        size_t min_index = nearest(hash_result, m_templ_hashes);
+        m_min_dist_name.emplace_back(min_index < m_templ_names.size() ? m_templ_names[min_index] : std::string());
+        m_hash_result.emplace_back(hash_result);
     }
 
     return true;
@@ -62,9 +58,28 @@ void asst::Hasher::set_mask_range(std::pair<int, int> mask_range) noexcept
     m_mask_range = std::move(mask_range);
 }
 
-void asst::Hasher::set_hash_templates(std::unordered_map<std::string, std::string> hash_templates) noexcept
+void asst::Hasher::set_hash_templates(std::unordered_map<std::string, std::string> hash_templates)
+{
+    m_templ_names.clear();
+    m_templ_hashes.clear();
+    m_templ_names.reserve(hash_templates.size());
+    m_templ_hashes.reserve(hash_templates.size());
+    for (auto&& [name, templ] : hash_templates) {
+        m_templ_names.emplace_back(name);
+        m_templ_hashes.emplace_back(from_string(templ));
+    }
+}
+
+void asst::Hasher::set_hash_templates(std::vector<std::pair<std::string, HashValue>> hash_templates)
 {
-    m_hash_templates = std::move(hash_templates);
+    m_templ_names.clear();
+    m_templ_hashes.clear();
+    m_templ_names.reserve(hash_templates.size());
+    m_templ_hashes.reserve(hash_templates.size());
+    for (auto&& [name, templ] : hash_templates) {
+        m_templ_names.emplace_back(std::move(name));
+        m_templ_hashes.emplace_back(templ);
+    }
 }
 
 void asst::Hasher::set_need_split(bool need_split) noexcept
@@ -82,14 +97,16 @@ const std::vector<std::string>& asst::Hasher::get_min_dist_name() const noexcept
     return m_min_dist_name;
 }
 
-const std::vector<std::string>& asst::Hasher::get_hash() const noexcept
+const std::vector<asst::Hasher::HashValue>& asst::Hasher::get_hash() const noexcept
 {
     return m_hash_result;
 }
 
-std::string asst::Hasher::s_hash(const cv::Mat& img)
+asst::Hasher::HashValue asst::Hasher::s_hash(const cv::Mat& img)
 {
     static constexpr int HashKernelSize = 16;
+    static_assert(HashKernelSize * HashKernelSize == std::tuple_size_v<HashValue> * 64);
+
     cv::Mat resized;
     cv::resize(img, resized, cv::Size(HashKernelSize, HashKernelSize));
     if (img.channels() == 3) {
@@ -97,19 +114,87 @@ std::string asst::Hasher::s_hash(const cv::Mat& img)
         cv::cvtColor(resized, temp, cv::COLOR_BGR2GRAY);
         resized = temp;
     }
-    std::stringstream hash_value;
-    uchar* pix = resized.data;
-    int tmp_dec = 0;
-    for (int ro = 0; ro < 256; ro++) {
-        tmp_dec = tmp_dec << 1;
-        if (*pix > 127) tmp_dec++;
-        if (ro % 4 == 3) {
-            hash_value << std::hex << tmp_dec;
-            tmp_dec = 0;
+    HashValue hash_value {};
+    const uchar* pix = resized.data;
+    for (uint64_t& word : hash_value) {
+        for (int bit = 0; bit < 64; ++bit) {
+            word = (word << 1) | static_cast<uint64_t>(*pix > 127);
+            pix++;
+        }
+    }
+    return hash_value;
+}
+
+int asst::Hasher::hamming(const HashValue& hash1, const HashValue& hash2) noexcept
+{
+    int dist = 0;
+    for (size_t i = 0; i < hash1.size(); ++i) {
+        dist += std::popcount(hash1[i] ^ hash2[i]);
+    }
+    return dist;
+}
+
+size_t asst::Hasher::nearest(const HashValue& hash, std::span<const HashValue> templs, int* min_dist)
+{
+    size_t min_index = templs.size();
+    int cur_min_dist = INT_MAX;
+    for (size_t i = 0; i < templs.size(); ++i) {
+        // 距离按固定的 4 个字计算，不用循环，编译器会展开成 popcnt 指令；只有比较最小值时有分支
+        const HashValue& templ = templs[i];
+        int dist = std::popcount(hash[0] ^ templ[0]) + std::popcount(hash[1] ^ templ[1]) +
+                   std::popcount(hash[2] ^ templ[2]) + std::popcount(hash[3] ^ templ[3]);
+        if (dist < cur_min_dist) {
+            cur_min_dist = dist;
+            min_index = i;
         }
-        pix++;
     }
-    return hash_value.str();
+    if (min_dist) {
+        *min_dist = cur_min_dist;
+    }
+    return min_index;
+}
+
+std::string asst::Hasher::to_string(const HashValue& hash)
+{
+    static constexpr std::string_view HexDigits = "0123456789abcdef";
+
+    std::string result;
+    result.reserve(hash.size() * 16);
+    for (uint64_t word : hash) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            result.push_back(HexDigits[(word >> shift) & 0xF]);
+        }
+    }
+    return result;
+}
+
+asst::Hasher::HashValue asst::Hasher::from_string(std::string_view hex)
+{
+    static constexpr size_t HexLength = std::tuple_size_v<HashValue> * 16;
+
+    // 兼容旧格式：不足 64 位的左侧补 0
+    if (hex.size() > HexLength) {
+        hex = hex.substr(hex.size() - HexLength);
+    }
+    const size_t padding = HexLength - hex.size();
+
+    HashValue hash_value {};
+    for (size_t i = 0; i < hex.size(); ++i) {
+        const char c = hex[i];
+        uint64_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        }
+        const size_t pos = padding + i;
+        hash_value[pos / 16] |= nibble << ((15 - pos % 16) * 4);
+    }
+    return hash_value;
 }
 
 std::vector<cv::Mat> asst::Hasher::split_bin(const cv::Mat& bin)
@@ -151,21 +236,3 @@ cv::Mat asst::Hasher::bound_bin(const cv::Mat& bin)
 {
     return bin(cv::boundingRect(bin));
 }
-
-int asst::Hasher::hamming(std::string hash1, std::string hash2)
-{
-    static constexpr int HammingFlags = 64;
-
-    hash1.insert(hash1.begin(), HammingFlags - hash1.size(), '0');
-    hash2.insert(hash2.begin(), HammingFlags - hash2.size(), '0');
-    int dist = 0;
-    for (int i = 0; i < HammingFlags; i = i + 16) {
-        unsigned long long x =
-            strtoull(hash1.substr(i, 16).c_str(), nullptr, 16) ^ strtoull(hash2.substr(i, 16).c_str(), nullptr, 16);
-        while (x) {
-            ++dist;
-            x = x & (x - 1);
-        }
-    }
-    return dist;
-}
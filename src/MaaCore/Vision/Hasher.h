@@ -1,6 +1,8 @@
 #pragma once
 #include "VisionHelper.h"
 
+#include <span>
+#include <string_view>
 #include <unordered_map>
 
 namespace asst
@@ -8,6 +10,9 @@ namespace asst
     // FIXME: 删掉这个类，以及对应的 task 类型
     class Hasher : public VisionHelper
     {
+    public:
+        using HashValue = PerceptualHash;
+
     public:
         using VisionHelper::VisionHelper;
         virtual ~Hasher() override = default;
@@ -16,25 +21,32 @@ namespace asst
 
         void set_mask_range(int lower, int upper) noexcept;
         void set_mask_range(std::pair<int, int> mask_range) noexcept;
-        void set_hash_templates(std::unordered_map<std::string, std::string> hash_templates) noexcept;
+        void set_hash_templates(std::unordered_map<std::string, std::string> hash_templates);
+        void set_hash_templates(std::vector<std::pair<std::string, HashValue>> hash_templates);
         void set_need_split(bool need_split) noexcept;
         void set_need_bound(bool need_bound) noexcept;
 
         const std::vector<std::string>& get_min_dist_name() const noexcept;
-        const std::vector<std::string>& get_hash() const noexcept;
-
-        static std::string s_hash(const cv::Mat& img);
-        static int hamming(std::string hash1, std::string hash2);
+        const std::vector<HashValue>& get_hash() const noexcept;
+
+        static HashValue s_hash(const cv::Mat& img);
+        static int hamming(const HashValue& hash1, const HashValue& hash2) noexcept;
+        // 返回 templs 中距离最小的下标，templs 为空时返回 templs.size()
+        static size_t nearest(const HashValue& hash, std::span<const HashValue> templs, int* min_dist = nullptr);
+        static std::string to_string(const HashValue& hash);
+        static HashValue from_string(std::string_view hex);
         static std::vector<cv::Mat> split_bin(const cv::Mat& bin);
         static cv::Mat bound_bin(const cv::Mat& bin);
 
     protected:
         std::pair<int, int> m_mask_range;
-        std::unordered_map<std::string, std::string> m_hash_templates;
+        // 模板名与模板 hash 分开连续存放，方便一次性算完所有距离
+        std::vector<std::string> m_templ_names;
+        std::vector<HashValue> m_templ_hashes;
         bool m_need_split = false;
         bool m_need_bound = false;
 
-        std::vector<std::string> m_hash_result;
+        std::vector<HashValue> m_hash_result;
         std::vector<std::string> m_min_dist_name;
     };
 }
@@ -4,6 +4,7 @@
 
 #include "Config/TaskData.h"
 #include "Config/TemplResource.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 #include "Utils/StringMisc.hpp"
 
@@ -11,6 +12,8 @@ using namespace asst;
 
 Matcher::ResultOpt Matcher::analyze() const
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "Matcher");
+
     const auto match_results = preproc_and_match(make_roi(m_image, m_roi), m_params);
 
     for (size_t i = 0; i < match_results.size(); ++i) {
@@ -54,6 +57,12 @@ Matcher::ResultOpt Matcher::analyze() const
 std::vector<Matcher::RawResult> Matcher::preproc_and_match(const cv::Mat& image, const MatcherConfig::Params& params)
 {
     std::vector<Matcher::RawResult> results;
+
+    // 原图的颜色转换与模板无关，多个模板共用一份
+    cv::Mat image_match, image_gray, image_hsv;
+    cv::cvtColor(image, image_match, cv::COLOR_BGR2RGB);
+    cv::cvtColor(image, image_gray, cv::COLOR_BGR2GRAY);
+
     for (size_t i = 0; i != params.templs.size(); ++i) {
         const auto& ptempl = params.templs[i];
         auto method = MatchMethod::Ccoeff;
@@ -99,14 +108,15 @@ std::vector<Matcher::RawResult> Matcher::preproc_and_match(const cv::Mat& image,
         }
 
         cv::Mat matched;
-        cv::Mat image_match, image_count, image_gray;
+        cv::Mat image_count;
         cv::Mat templ_match, templ_count, templ_gray;
-        cv::cvtColor(image, image_match, cv::COLOR_BGR2RGB);
         cv::cvtColor(templ, templ_match, cv::COLOR_BGR2RGB);
-        cv::cvtColor(image, image_gray, cv::COLOR_BGR2GRAY);
         cv::cvtColor(templ, templ_gray, cv::COLOR_BGR2GRAY);
         if (method == MatchMethod::HSVCount) {
-            cv::cvtColor(image, image_count, cv::COLOR_BGR2HSV);
+            if (image_hsv.empty()) {
+                cv::cvtColor(image, image_hsv, cv::COLOR_BGR2HSV);
+            }
+            image_count = image_hsv;
             cv::cvtColor(templ, templ_count, cv::COLOR_BGR2HSV);
         }
         else if (method == MatchMethod::RGBCount) {
@@ -5,11 +5,20 @@
 #include "Config/Miscellaneous/ItemConfig.h"
 #include "Config/TaskData.h"
 #include "Config/TemplResource.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
-#include "Vision/Matcher.h"
 #include "Vision/RegionOCRer.h"
 
+#include <future>
+#include <mutex>
 #include <numbers>
+#include <thread>
+
+// 右下角数量区域，匹配时需要涂黑
+static cv::Rect quantity_corner(const cv::Size& size)
+{
+    return cv::Rect { size.width - 80, size.height - 50, 80, 50 } & cv::Rect { 0, 0, size.width, size.height };
+}
 
 bool asst::DepotImageAnalyzer::analyze()
 {
@@ -25,6 +34,11 @@ bool asst::DepotImageAnalyzer::analyze()
         return false;
     }
 
+    // TemplResource 不是线程安全的，必须在并行匹配之前准备好索引
+    m_templ_index = get_templ_index();
+    const auto& thresholds = Task.get<MatchTaskInfo>("DepotMatchData")->templ_thresholds;
+    m_templ_thres = thresholds.empty() ? 0.0 : thresholds.front();
+
     ret = analyze_all_items();
 
 #ifdef ASST_DEBUG
@@ -123,12 +137,42 @@ bool asst::DepotImageAnalyzer::analyze_all_items()
 {
     LogTraceFunction;
 
-    for (const Rect& roi : m_all_items_roi) {
+    // 先并行地以本页起点为下界识别所有格子，再按顺序校正
+    // 格子之间只有“物品序号单调递增”这一个依赖，绝大多数情况下并行结果就是最终结果
+    std::vector<ItemInfo> pre_infos(m_all_items_roi.size());
+    std::vector<size_t> pre_pos(m_all_items_roi.size(), NPos);
+    {
+        const size_t thread_count =
+            std::clamp<size_t>(std::thread::hardware_concurrency(), 1, (std::max)(m_all_items_roi.size(), size_t(1)));
+        // 识别器通过 PerfStats::current() 记录耗时，工作线程也要绑定到本实例
+        PerfStats* perf_stats = PerfStats::current();
+        std::vector<std::future<void>> futures;
+        futures.reserve(thread_count);
+        for (size_t t = 0; t < thread_count; ++t) {
+            futures.emplace_back(std::async(std::launch::async, [&, t, perf_stats]() {
+                PerfStats::Binding binding(perf_stats);
+                for (size_t i = t; i < m_all_items_roi.size(); i += thread_count) {
+                    pre_pos[i] = match_item(m_all_items_roi[i], pre_infos[i], m_match_begin_pos);
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+    }
+
+    for (size_t i = 0; i < m_all_items_roi.size(); ++i) {
+        const Rect& roi = m_all_items_roi[i];
         if (check_roi_empty(roi)) { // roi 是竖着有序的
             break;
         }
-        ItemInfo info;
-        size_t cur_pos = match_item(roi, info, m_match_begin_pos);
+        ItemInfo info = std::move(pre_infos[i]);
+        size_t cur_pos = pre_pos[i];
+        if (cur_pos != NPos && cur_pos < m_match_begin_pos) {
+            // 与前面的格子顺序冲突，按原来的方式从上一个结果之后重新匹配
+            info = ItemInfo();
+            cur_pos = match_item(roi, info, m_match_begin_pos);
+        }
         if (cur_pos == NPos) {
             break;
         }
@@ -165,54 +209,214 @@ bool asst::DepotImageAnalyzer::check_roi_empty(const Rect& roi)
     return false;
 }
 
-size_t asst::DepotImageAnalyzer::match_item(const Rect& roi, /* out */ ItemInfo& item_info, size_t begin_index,
-                                            bool with_enlarge)
+std::shared_ptr<const asst::DepotImageAnalyzer::ItemTemplIndex> asst::DepotImageAnalyzer::get_templ_index()
 {
-    LogTraceFunction;
+    static std::mutex index_mutex;
+    static std::shared_ptr<const ItemTemplIndex> index_cache;
+
+    std::unique_lock<std::mutex> lock(index_mutex);
 
     const auto& all_items = ItemData.get_ordered_material_item_id();
+    const auto& mask_ranges = Task.get<MatchTaskInfo>("DepotMatchData")->mask_ranges;
+    auto& templ_res = TemplResource::get_instance();
+
+    if (index_cache && index_cache->mask_ranges == mask_ranges && index_cache->items.size() == all_items.size() &&
+        ranges::equal(index_cache->items, all_items, [&](const ItemTemplFeature& feature, const std::string& id) {
+            return feature.item_id == id && feature.raw_templ.data == templ_res.get_templ(id).data;
+        })) {
+        return index_cache;
+    }
 
-    Matcher analyzer(m_image_resized);
-    analyzer.set_task_info("DepotMatchData");
-    // spacing 有时候算的差一个像素，干脆把 roi 扩大一点好了
-    Rect enlarged_roi = roi;
-    if (with_enlarge) {
-        enlarged_roi = Rect(roi.x - 20, roi.y - 5, roi.width + 40, roi.height + 10);
+    LogTraceScope("build depot item templ index");
+
+    auto index = std::make_shared<ItemTemplIndex>();
+    index->mask_ranges = mask_ranges;
+    index->items.reserve(all_items.size());
+    for (const std::string& item_id : all_items) {
+        ItemTemplFeature feature;
+        feature.item_id = item_id;
+        feature.raw_templ = templ_res.get_templ(item_id);
+        if (feature.raw_templ.empty()) {
+            // 保留占位，以保证下标与 get_ordered_material_item_id 一致
+            index->items.emplace_back(std::move(feature));
+            continue;
+        }
+        feature.templ = feature.raw_templ.clone();
+        feature.templ(quantity_corner(feature.templ.size())) = cv::Scalar { 0, 0, 0 };
+
+        // 与 Matcher 中的掩码计算方式一致：灰度范围作用于灰度图，彩色范围作用于 RGB 图
+        cv::Mat templ_gray, templ_rgb;
+        cv::cvtColor(feature.templ, templ_gray, cv::COLOR_BGR2GRAY);
+        cv::cvtColor(feature.templ, templ_rgb, cv::COLOR_BGR2RGB);
+        if (!mask_ranges.empty()) {
+            feature.mask = cv::Mat::zeros(templ_gray.size(), CV_8UC1);
+            for (const auto& range : mask_ranges) {
+                cv::Mat current_mask;
+                if (std::holds_alternative<MatchTaskInfo::GrayRange>(range)) {
+                    const auto& [lower, upper] = std::get<MatchTaskInfo::GrayRange>(range);
+                    cv::inRange(templ_gray, lower, upper, current_mask);
+                }
+                else {
+                    const auto& [lower, upper] = std::get<MatchTaskInfo::ColorRange>(range);
+                    cv::inRange(templ_rgb, lower, upper, current_mask);
+                }
+                cv::bitwise_or(feature.mask, current_mask, feature.mask);
+            }
+        }
+
+        cv::Mat hist_mask(feature.templ.size(), CV_8UC1, cv::Scalar { 255 });
+        hist_mask(quantity_corner(hist_mask.size())) = cv::Scalar { 0 };
+        feature.hist = calc_item_hist(feature.templ, hist_mask);
+
+        index->items.emplace_back(std::move(feature));
+    }
+
+    index_cache = std::move(index);
+    return index_cache;
+}
+
+cv::Mat asst::DepotImageAnalyzer::calc_item_hist(const cv::Mat& image, const cv::Mat& mask)
+{
+    static constexpr int HBins = 18;
+    static constexpr int SBins = 8;
+    static const int channels[] = { 0, 1 };
+    static const int hist_size[] = { HBins, SBins };
+    static const float h_ranges[] = { 0, 180 };
+    static const float s_ranges[] = { 0, 256 };
+    static const float* hist_ranges[] = { h_ranges, s_ranges };
+
+    cv::Mat hsv;
+    cv::cvtColor(image, hsv, cv::COLOR_BGR2HSV);
+    cv::Mat hist;
+    cv::calcHist(&hsv, 1, channels, mask, hist, 2, hist_size, hist_ranges);
+    cv::normalize(hist, hist, 1, 0, cv::NORM_L1);
+    return hist;
+}
+
+std::vector<size_t> asst::DepotImageAnalyzer::shortlist_candidates(const Rect& roi, size_t begin_index) const
+{
+    // 颜色直方图相近的前若干个，再做精确的模板匹配
+    static constexpr size_t CandidateCount = 12;
+
+    const auto& items = m_templ_index->items;
+    if (begin_index >= items.size()) {
+        return {};
     }
-    analyzer.set_roi(enlarged_roi);
-
-    MatchRect matched;
-    std::string matched_item_id;
-    size_t matched_index = NPos;
-    for (size_t index = begin_index, extra_count = 0; index < all_items.size(); ++index) {
-        const std::string& item_id = all_items.at(index);
-        // analyzer.set_templ(item_id);
-        // TODO: too slow? find a way to set mask directly
-        cv::Mat templ = TemplResource::get_instance().get_templ(item_id).clone();
-        templ(cv::Rect { templ.cols - 80, templ.rows - 50, 80, 50 }) = cv::Scalar { 0, 0, 0 };
-        analyzer.set_templ(templ);
-        if (!analyzer.analyze()) {
+
+    cv::Mat cell = make_roi(m_image_resized, correct_rect(roi, m_image_resized));
+    cv::Mat cell_mask(cell.size(), CV_8UC1, cv::Scalar { 255 });
+    cell_mask(quantity_corner(cell_mask.size())) = cv::Scalar { 0 };
+    cv::Mat cell_hist = calc_item_hist(cell, cell_mask);
+
+    std::vector<std::pair<double, size_t>> similarities;
+    similarities.reserve(items.size() - begin_index);
+    for (size_t index = begin_index; index < items.size(); ++index) {
+        if (items[index].hist.empty()) {
             continue;
         }
-        if (double score = analyzer.get_result().score; score >= matched.score) {
-            matched = analyzer.get_result();
-            matched_item_id = item_id;
-            matched_index = index;
+        double similarity = cv::compareHist(cell_hist, items[index].hist, cv::HISTCMP_CORREL);
+        similarities.emplace_back(similarity, index);
+    }
+
+    const size_t count = (std::min)(CandidateCount, similarities.size());
+    std::partial_sort(similarities.begin(), similarities.begin() + count, similarities.end(), std::greater {});
+
+    std::vector<size_t> candidates;
+    candidates.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        candidates.emplace_back(similarities[i].second);
+    }
+    // 保持原有的顺序语义：得分相同时取序号靠后的
+    ranges::sort(candidates);
+    return candidates;
+}
+
+asst::DepotImageAnalyzer::ItemMatchResult asst::DepotImageAnalyzer::match_item_candidates(
+    const cv::Mat& enlarged_image, const Rect& enlarged_roi, const std::vector<size_t>& candidates) const
+{
+    ItemMatchResult result;
+    for (size_t index : candidates) {
+        const auto& feature = m_templ_index->items[index];
+        if (feature.templ.empty() || feature.templ.cols > enlarged_image.cols ||
+            feature.templ.rows > enlarged_image.rows) {
+            continue;
+        }
+
+        // TM_CCOEFF_NORMED 对通道顺序不敏感，这里直接用 BGR 匹配，省掉 Matcher 里的颜色转换
+        cv::Mat matched;
+        if (feature.mask.empty()) {
+            cv::matchTemplate(enlarged_image, feature.templ, matched, cv::TM_CCOEFF_NORMED);
+        }
+        else {
+            cv::matchTemplate(enlarged_image, feature.templ, matched, cv::TM_CCOEFF_NORMED, feature.mask);
+        }
+
+        double max_val = 0.0;
+        cv::Point max_loc;
+        cv::minMaxLoc(matched, nullptr, &max_val, nullptr, &max_loc);
+        if (std::isnan(max_val) || std::isinf(max_val)) {
+            max_val = 0;
+        }
+        if (max_val < m_templ_thres || max_val < result.score) {
+            continue;
+        }
+        result.index = index;
+        result.score = max_val;
+        result.rect = Rect(max_loc.x + enlarged_roi.x, max_loc.y + enlarged_roi.y, feature.templ.cols,
+                           feature.templ.rows);
+    }
+    return result;
+}
+
+asst::DepotImageAnalyzer::ItemMatchResult asst::DepotImageAnalyzer::match_item_sequential(
+    const cv::Mat& enlarged_image, const Rect& enlarged_roi, size_t begin_index) const
+{
+    ItemMatchResult result;
+    const size_t size = m_templ_index->items.size();
+    for (size_t index = begin_index, extra_count = 0; index < size; ++index) {
+        auto cur = match_item_candidates(enlarged_image, enlarged_roi, { index });
+        if (cur.index != NPos && cur.score >= result.score) {
+            result = cur;
         }
         // 匹配到了任一结果后，再往后匹配几个。
         // 因为有些相邻的材料长得很像（同一种类的）
         constexpr size_t MaxExtraMatch = 8;
-        if (matched_index != NPos && ++extra_count >= MaxExtraMatch) {
+        if (result.index != NPos && ++extra_count >= MaxExtraMatch) {
             break;
         }
     }
+    return result;
+}
+
+size_t asst::DepotImageAnalyzer::match_item(const Rect& roi, /* out */ ItemInfo& item_info, size_t begin_index,
+                                            bool with_enlarge) const
+{
+    LogTraceFunction;
+
+    // spacing 有时候算的差一个像素，干脆把 roi 扩大一点好了
+    Rect enlarged_roi = roi;
+    if (with_enlarge) {
+        enlarged_roi = Rect(roi.x - 20, roi.y - 5, roi.width + 40, roi.height + 10);
+    }
+    enlarged_roi = correct_rect(enlarged_roi, m_image_resized);
+    const cv::Mat enlarged_image = make_roi(m_image_resized, enlarged_roi);
+
+    ItemMatchResult matched =
+        match_item_candidates(enlarged_image, enlarged_roi, shortlist_candidates(roi, begin_index));
+    if (matched.index == NPos) {
+        // 粗筛没有命中，退回到逐个匹配
+        matched = match_item_sequential(enlarged_image, enlarged_roi, begin_index);
+    }
+
+    const std::string& matched_item_id =
+        matched.index == NPos ? std::string() : m_templ_index->items[matched.index].item_id;
     Log.info("Item id:", matched_item_id);
     if (matched_item_id.empty()) {
         return NPos;
     }
     item_info.item_id = matched_item_id;
     item_info.rect = matched.rect;
-    return matched_index;
+    return matched.index;
 }
 
 int asst::DepotImageAnalyzer::match_quantity(const ItemInfo& item)
@@ -1,6 +1,8 @@
 #pragma once
 #include "Vision/VisionHelper.h"
 
+#include <memory>
+
 namespace asst
 {
     struct ItemInfo
@@ -26,19 +28,51 @@ namespace asst
         const auto& get_result() const noexcept { return m_result; }
 
     private:
+        // 预处理过的材料模板，每次资源变化后重建一次，所有实例共享
+        struct ItemTemplFeature
+        {
+            std::string item_id;
+            cv::Mat raw_templ; // TemplResource 中原始模板的浅拷贝，用于判断资源是否被重新加载
+            cv::Mat templ;     // 已涂黑右下角数量区域
+            cv::Mat mask;
+            cv::Mat hist; // HSV 颜色直方图，用于粗筛
+        };
+        struct ItemTemplIndex
+        {
+            MatchTaskInfo::Ranges mask_ranges;
+            std::vector<ItemTemplFeature> items;
+        };
+
+        struct ItemMatchResult
+        {
+            size_t index = NPos;
+            double score = 0.0;
+            Rect rect;
+        };
+
+        static std::shared_ptr<const ItemTemplIndex> get_templ_index();
+        static cv::Mat calc_item_hist(const cv::Mat& image, const cv::Mat& mask);
+
         void resize();
         bool analyze_base_rect();
         bool analyze_all_items();
 
         bool check_roi_empty(const Rect& roi);
         size_t match_item(const Rect& roi, /* out */ ItemInfo& item_info, size_t begin_index = 0ULL,
-                          bool with_enlarge = true);
+                          bool with_enlarge = true) const;
+        ItemMatchResult match_item_candidates(const cv::Mat& enlarged_image, const Rect& enlarged_roi,
+                                              const std::vector<size_t>& candidates) const;
+        ItemMatchResult match_item_sequential(const cv::Mat& enlarged_image, const Rect& enlarged_roi,
+                                              size_t begin_index) const;
+        std::vector<size_t> shortlist_candidates(const Rect& roi, size_t begin_index) const;
         int match_quantity(const ItemInfo& item);
         Rect resize_rect_to_raw_size(const Rect& rect);
 
         template <typename F>
         static cv::Mat image_from_function(const cv::Size& size, const F& func);
 
+        std::shared_ptr<const ItemTemplIndex> m_templ_index;
+        double m_templ_thres = 0.0;
         size_t m_match_begin_pos = 0ULL;
         Rect m_resized_rect;
         cv::Mat m_image_resized;
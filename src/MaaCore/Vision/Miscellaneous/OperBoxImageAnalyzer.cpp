@@ -74,18 +74,18 @@ bool asst::OperBoxImageAnalyzer::opers_analyze()
     Rect roi_top = Task.get("OperBoxFlagRoleTopROI")->roi;
     Rect roi_bottom = Task.get("OperBoxFlagRoleBottomROI")->roi;
 
+    // 九个职业的 flag 合并为一次多模板匹配，上下两行各识别一次
+    std::vector<std::string> flag_tasks;
     for (int i = 1; i < 10; ++i) {
-        oper_name_analyzer.set_task_info("OperBoxFlagRole" + std::to_string(i), "OperBoxNameOCR");
-        oper_name_analyzer.set_required(std::vector(all_opers.begin(), all_opers.end()));
-
-        oper_name_analyzer.set_roi(roi_top);
-        if (auto top_result_opt = oper_name_analyzer.analyze()) {
-            ranges::move(*top_result_opt, std::back_inserter(results));
-        }
+        flag_tasks.emplace_back("OperBoxFlagRole" + std::to_string(i));
+    }
+    oper_name_analyzer.set_task_info(flag_tasks, "OperBoxNameOCR");
+    oper_name_analyzer.set_required(std::vector(all_opers.begin(), all_opers.end()));
 
-        oper_name_analyzer.set_roi(roi_bottom);
-        if (auto bottom_result_opt = oper_name_analyzer.analyze()) {
-            ranges::move(*bottom_result_opt, std::back_inserter(results));
+    for (const Rect& roi : { roi_top, roi_bottom }) {
+        oper_name_analyzer.set_roi(roi);
+        if (auto result_opt = oper_name_analyzer.analyze()) {
+            ranges::move(*result_opt, std::back_inserter(results));
         }
     }
 
@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "Config/TaskData.h"
+#include "PerfStats.h"
 #include "Status.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Matcher.h"
@@ -14,6 +15,8 @@ using namespace asst;
 
 PipelineAnalyzer::ResultOpt PipelineAnalyzer::analyze() const
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "PipelineAnalyzer");
+
     for (const std::string& task_name : m_tasks_name) {
         const auto& task_ptr = Task.get(task_name);
         // 可能有配置错误，导致不存在对应的任务
@@ -1,12 +1,14 @@
 #include "MultiMatcher.h"
 
 #include "Utils/Ranges.hpp"
+#include <unordered_map>
 #include <utility>
 
 #include "Utils/NoWarningCV.h"
 
 #include "Config/TaskData.h"
 #include "Config/TemplResource.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Matcher.h"
 
@@ -14,9 +16,23 @@ using namespace asst;
 
 MultiMatcher::ResultsVecOpt MultiMatcher::analyze() const
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "MultiMatcher");
+
     auto match_results = Matcher::preproc_and_match(make_roi(m_image, m_roi), m_params);
 
     std::vector<Result> results;
+    // 已有结果按 min_distance 大小的格子分桶，相邻判定只需要看周围 3x3 个格子
+    std::unordered_map<int64_t, std::vector<size_t>> grid;
+    int cell_size = 0;
+    auto cell_of = [&](int v) { return v >= 0 ? v / cell_size : (v - cell_size + 1) / cell_size; };
+    auto cell_key = [](int cell_x, int cell_y) {
+        return (static_cast<int64_t>(cell_x) << 32) | static_cast<uint32_t>(cell_y);
+    };
+    auto grid_insert = [&](size_t result_index) {
+        const Rect& rect = results[result_index].rect;
+        grid[cell_key(cell_of(rect.x), cell_of(rect.y))].emplace_back(result_index);
+    };
+
     for (size_t index = 0; index < match_results.size(); ++index) {
         const auto& [matched, templ, templ_name] = match_results[index];
         if (matched.empty()) {
@@ -25,39 +41,74 @@ MultiMatcher::ResultsVecOpt MultiMatcher::analyze() const
 
         double threshold = m_params.templ_thres[index];
         int min_distance = (std::min)(templ.cols, templ.rows) / 2;
-        for (int i = 0; i != matched.rows; ++i) {
-            for (int j = 0; j != matched.cols; ++j) {
-                auto value = matched.at<float>(i, j);
-                if (value < threshold || std::isnan(value) || std::isinf(value)) {
-                    continue;
-                }
 
-                Rect rect(j + m_roi.x, i + m_roi.y, templ.cols, templ.rows);
-                bool need_push = true;
-                // 如果有两个点离得太近，只取里面得分高的那个
-                // 一般相邻的都是刚刚push进去的，这里倒序快一点
-                for (auto& iter : ranges::reverse_view(results)) {
-                    if (std::abs(j + m_roi.x - iter.rect.x) >= min_distance ||
-                        std::abs(i + m_roi.y - iter.rect.y) >= min_distance) {
+        // 不同模板的 min_distance 不同，按当前模板重新分桶
+        if (int new_cell_size = (std::max)(min_distance, 1); new_cell_size != cell_size) {
+            cell_size = new_cell_size;
+            grid.clear();
+            for (size_t i = 0; i < results.size(); ++i) {
+                grid_insert(i);
+            }
+        }
+
+        // 先整体筛出超过阈值的点（NaN 比较结果为 false 会被直接排除），顺序与逐行逐列遍历一致
+        cv::Mat above_threshold;
+        cv::compare(matched, threshold, above_threshold, cv::CMP_GE);
+        std::vector<cv::Point> candidates;
+        cv::findNonZero(above_threshold, candidates);
+
+        for (const cv::Point& candidate : candidates) {
+            const int i = candidate.y;
+            const int j = candidate.x;
+            auto value = matched.at<float>(i, j);
+            // 阈值在 compare 里会被转成 float，这里再按 double 精确比较一次
+            if (value < threshold || std::isinf(value)) {
+                continue;
+            }
+
+            Rect rect(j + m_roi.x, i + m_roi.y, templ.cols, templ.rows);
+            // 如果有两个点离得太近，只取里面得分高的那个
+            // 与最近加入的那个相邻结果比较，即所有相邻结果中下标最大的
+            std::optional<size_t> neighbor;
+            const int cell_x = cell_of(rect.x);
+            const int cell_y = cell_of(rect.y);
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    auto iter = grid.find(cell_key(cell_x + dx, cell_y + dy));
+                    if (iter == grid.end()) {
                         continue;
                     }
-
-                    if (iter.score < value) {
-                        iter.rect = rect;
-                        iter.score = value;
-                        iter.templ_name = templ_name;
-                    } // else 这个点就放弃了
-                    need_push = false;
-                    break;
-                }
-                if (need_push) {
-                    Result tmp;
-                    tmp.rect = rect;
-                    tmp.score = value;
-                    tmp.templ_name = templ_name;
-                    results.emplace_back(std::move(tmp));
+                    for (size_t result_index : iter->second) {
+                        const Rect& exist = results[result_index].rect;
+                        if (std::abs(rect.x - exist.x) >= min_distance || std::abs(rect.y - exist.y) >= min_distance) {
+                            continue;
+                        }
+                        if (!neighbor || result_index > *neighbor) {
+                            neighbor = result_index;
+                        }
+                    }
                 }
             }
+
+            if (!neighbor) {
+                Result tmp;
+                tmp.rect = rect;
+                tmp.score = value;
+                tmp.templ_name = templ_name;
+                results.emplace_back(std::move(tmp));
+                grid_insert(results.size() - 1);
+                continue;
+            }
+
+            Result& exist = results[*neighbor];
+            if (exist.score < value) {
+                auto& cell = grid[cell_key(cell_of(exist.rect.x), cell_of(exist.rect.y))];
+                cell.erase(ranges::find(cell, *neighbor));
+                exist.rect = rect;
+                exist.score = value;
+                exist.templ_name = templ_name;
+                grid_insert(*neighbor);
+            } // else 这个点就放弃了
         }
     }
 
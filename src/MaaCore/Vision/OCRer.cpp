@@ -1,17 +1,17 @@
 #include "OCRer.h"
 
-#include <regex>
-#include <unordered_map>
-
 #include "Config/Miscellaneous/OcrConfig.h"
 #include "Config/Miscellaneous/OcrPack.h"
 #include "Config/TaskData.h"
+#include "PerfStats.h"
 #include "Utils/Logger.hpp"
 
 using namespace asst;
 
 OCRer::ResultsVecOpt OCRer::analyze() const
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "OCRer");
+
     OcrPack* ocr_ptr = nullptr;
     if (m_params.use_char_model) {
         ocr_ptr = &CharOcr::get_instance();
@@ -23,6 +23,7 @@ OCRer::ResultsVecOpt OCRer::analyze() const
     ocr_ptr = nullptr;
 
     /* post process */
+    const auto replace_regexes = compile_replace_();
     ResultsVec results_vec;
     for (Result& res : raw_results) {
         if (res.text.empty() || std::isnan(res.score) || std::isinf(res.score)) {
@@ -31,7 +32,7 @@ OCRer::ResultsVecOpt OCRer::analyze() const
 
         postproc_rect_(res);
         postproc_trim_(res);
-        postproc_replace_(res);
+        postproc_replace_(res, replace_regexes);
 
         if (!filter_and_replace_by_required_(res)) {
             continue;
@@ -50,6 +51,58 @@ OCRer::ResultsVecOpt OCRer::analyze() const
     return m_result;
 }
 
+std::vector<OCRer::ResultOpt> OCRer::analyze_batch(
+    const std::vector<cv::Mat>& images,
+    const std::vector<Rect>& rects) const
+{
+    std::vector<ResultOpt> results(images.size());
+    if (images.empty()) {
+        return results;
+    }
+    if (images.size() != rects.size()) {
+        Log.error(__FUNCTION__, "images and rects size mismatch", images.size(), rects.size());
+        return results;
+    }
+
+    OcrPack* ocr_ptr = nullptr;
+    if (m_params.use_char_model) {
+        ocr_ptr = &CharOcr::get_instance();
+    }
+    else {
+        ocr_ptr = &WordOcr::get_instance();
+    }
+    ResultsVec raw_results = ocr_ptr->recognize_batch(images);
+    ocr_ptr = nullptr;
+
+    /* post process */
+    // 正则与 required 索引对整批结果只构建一次
+    const auto replace_regexes = compile_replace_();
+    const auto required_index = build_required_index_();
+    ResultsVec results_vec;
+    for (size_t i = 0; i < raw_results.size() && i < results.size(); ++i) {
+        Result& res = raw_results[i];
+        if (res.text.empty() || std::isnan(res.score) || std::isinf(res.score)) {
+            continue;
+        }
+
+        res.rect = rects[i];
+        postproc_trim_(res);
+        postproc_replace_(res, replace_regexes);
+
+        if (!filter_and_replace_by_required_(res, &required_index)) {
+            continue;
+        }
+
+        results_vec.emplace_back(res);
+        results[i] = std::move(res);
+    }
+
+    if (!results_vec.empty()) {
+        Log.trace("Proceed", results_vec);
+    }
+    return results;
+}
+
 void OCRer::postproc_rect_(Result& res) const
 {
     if (m_params.without_det) {
@@ -66,25 +119,43 @@ void OCRer::postproc_trim_(Result& res) const
     utils::string_trim(res.text);
 }
 
-void OCRer::postproc_replace_(Result& res) const
+void OCRer::postproc_replace_(Result& res, const ReplaceRegexes& regexes) const
 {
-    if (m_params.replace.empty()) {
-        return;
-    }
-
-    for (const auto& [regex, new_str] : m_params.replace) {
+    for (const auto& [regex, new_str] : regexes) {
         if (m_params.replace_full) {
-            if (std::regex_search(res.text, std::regex(regex))) {
+            if (std::regex_search(res.text, regex)) {
                 res.text = new_str;
             }
         }
         else {
-            res.text = std::regex_replace(res.text, std::regex(regex), new_str);
+            res.text = std::regex_replace(res.text, regex, new_str);
         }
     }
 }
 
-bool OCRer::filter_and_replace_by_required_(Result& res) const
+OCRer::ReplaceRegexes OCRer::compile_replace_() const
+{
+    ReplaceRegexes regexes;
+    regexes.reserve(m_params.replace.size());
+    for (const auto& [regex, new_str] : m_params.replace) {
+        regexes.emplace_back(std::regex(regex), new_str);
+    }
+    return regexes;
+}
+
+OCRer::RequiredIndex OCRer::build_required_index_() const
+{
+    RequiredIndex index;
+    index.first_index.reserve(m_params.required.size());
+    for (size_t i = 0; i < m_params.required.size(); ++i) {
+        const std::string& equ_str = m_params.required[i].second;
+        index.first_index.emplace(equ_str, i);
+        index.max_length = (std::max)(index.max_length, equ_str.size());
+    }
+    return index;
+}
+
+bool OCRer::filter_and_replace_by_required_(Result& res, const RequiredIndex* index) const
 {
     if (m_params.required.empty()) {
         return true;
@@ -92,6 +163,29 @@ bool OCRer::filter_and_replace_by_required_(Result& res) const
     auto& ocr_config = OcrConfig::get_instance();
     auto equ_text = ocr_config.process_equivalence_class(res.text);
 
+    if (index) {
+        const auto& first_index = index->first_index;
+        if (m_params.full_match) {
+            return first_index.contains(equ_text);
+        }
+        // 与下面逐个 find 的结果一致：取 required 中最靠前的、是 equ_text 子串的那一个
+        const std::string_view text_view = equ_text;
+        size_t matched = m_params.required.size();
+        for (size_t pos = 0; pos <= text_view.size(); ++pos) {
+            const size_t len_limit = (std::min)(index->max_length, text_view.size() - pos);
+            for (size_t len = (pos == 0 ? 0 : 1); len <= len_limit; ++len) {
+                if (auto iter = first_index.find(text_view.substr(pos, len)); iter != first_index.cend()) {
+                    matched = (std::min)(matched, iter->second);
+                }
+            }
+        }
+        if (matched == m_params.required.size()) {
+            return false;
+        }
+        res.text = m_params.required[matched].first;
+        return true;
+    }
+
     if (m_params.full_match) {
         auto required = m_params.required | views::transform([&](const auto& str) { return str.second; });
         return ranges::find(required, equ_text) != required.end();
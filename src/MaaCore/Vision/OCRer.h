@@ -1,6 +1,10 @@
 #pragma once
 #include "VisionHelper.h"
 
+#include <regex>
+#include <string_view>
+#include <unordered_map>
+
 #include "Common/AsstTypes.h"
 #include "Config/Miscellaneous/OcrPack.h"
 #include "Vision/Config/OCRerConfig.h"
@@ -11,6 +15,7 @@ namespace asst
     {
     public:
         using Result = OcrPack::Result;
+        using ResultOpt = std::optional<Result>;
         using ResultsVec = OcrPack::ResultsVec;
         using ResultsVecOpt = std::optional<ResultsVec>;
 
@@ -19,6 +24,9 @@ namespace asst
         virtual ~OCRer() override = default;
 
         ResultsVecOpt analyze() const;
+        // 批量识别已裁剪好的多个区域（仅识别，不检测），rects 为各区域在原图中的位置
+        // 结果与 images 一一对应，等价于逐个区域 without_det 调用 analyze()，但只推理一次
+        std::vector<ResultOpt> analyze_batch(const std::vector<cv::Mat>& images, const std::vector<Rect>& rects) const;
         // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
         const auto& get_result() const noexcept { return m_result; }
 
@@ -31,11 +39,21 @@ namespace asst
         using OCRerConfig::set_bin_trim_threshold;
 
     protected:
+        using ReplaceRegexes = std::vector<std::pair<std::regex, std::string>>;
+        struct RequiredIndex
+        {
+            // key: required 的等价文本, value: 在 required 中第一次出现的下标
+            std::unordered_map<std::string_view, size_t> first_index;
+            size_t max_length = 0;
+        };
+
         void postproc_rect_(Result& res) const;
         void postproc_trim_(Result& res) const;
-        void postproc_replace_(Result& res) const;
+        void postproc_replace_(Result& res, const ReplaceRegexes& regexes) const;
 
-        bool filter_and_replace_by_required_(Result& res) const;
+        ReplaceRegexes compile_replace_() const;
+        RequiredIndex build_required_index_() const;
+        bool filter_and_replace_by_required_(Result& res, const RequiredIndex* index = nullptr) const;
 
     private:
         // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
@@ -2,9 +2,85 @@
 
 #include "Utils/NoWarningCV.h"
 
+#include "PerfStats.h"
+
 using namespace asst;
 
 RegionOCRer::ResultOpt RegionOCRer::analyze() const
+{
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "RegionOCRer");
+
+    auto region_opt = preproc_region();
+    if (!region_opt) {
+        return std::nullopt;
+    }
+
+    OCRer ocr_analyzer(region_opt->image, region_opt->roi);
+    auto config = m_params;
+    config.without_det = true;
+    ocr_analyzer.set_params(std::move(config));
+
+    auto result = ocr_analyzer.analyze();
+    if (!result) {
+        return std::nullopt;
+    }
+    m_result = result->front();
+    if (!m_use_raw) {
+        m_result.rect.x += m_roi.x;
+        m_result.rect.y += m_roi.y;
+    }
+    return m_result;
+}
+
+std::vector<RegionOCRer::ResultOpt> RegionOCRer::analyze_batch(
+    const cv::Mat& image,
+    const std::vector<Rect>& rois,
+    const OCRerConfig::Params& params,
+    bool use_raw)
+{
+    std::vector<ResultOpt> results(rois.size());
+
+    std::vector<cv::Mat> region_images;
+    std::vector<Rect> region_rects;
+    std::vector<size_t> region_indices;
+    region_images.reserve(rois.size());
+    region_rects.reserve(rois.size());
+    region_indices.reserve(rois.size());
+    for (size_t i = 0; i < rois.size(); ++i) {
+        RegionOCRer region_analyzer(image, rois[i]);
+        region_analyzer.set_params(params);
+        region_analyzer.set_use_raw(use_raw);
+        auto region_opt = region_analyzer.preproc_region();
+        if (!region_opt) {
+            continue;
+        }
+        // 与 OCRer 构造时的处理一致
+        Rect rect = correct_rect(region_opt->roi, region_opt->image);
+        region_images.emplace_back(make_roi(region_opt->image, rect));
+        if (!use_raw) {
+            rect.x += region_analyzer.m_roi.x;
+            rect.y += region_analyzer.m_roi.y;
+        }
+        region_rects.emplace_back(rect);
+        region_indices.emplace_back(i);
+    }
+    if (region_images.empty()) {
+        return results;
+    }
+
+    OCRer ocr_analyzer;
+    auto config = params;
+    config.without_det = true;
+    ocr_analyzer.set_params(std::move(config));
+
+    auto ocr_results = ocr_analyzer.analyze_batch(region_images, region_rects);
+    for (size_t i = 0; i < ocr_results.size(); ++i) {
+        results[region_indices[i]] = std::move(ocr_results[i]);
+    }
+    return results;
+}
+
+std::optional<RegionOCRer::Region> RegionOCRer::preproc_region() const
 {
     cv::Mat img_roi = make_roi(m_image, m_roi);
     cv::Mat img_roi_gray;
@@ -37,31 +113,13 @@ RegionOCRer::ResultOpt RegionOCRer::analyze() const
     cv::rectangle(m_image_draw, make_rect<cv::Rect>(new_roi), cv::Scalar(0, 0, 255), 1);
 #endif // ASST_DEBUG
 
-    OCRer ocr_analyzer;
     if (m_use_raw) {
-        ocr_analyzer = OCRer(m_image, new_roi);
-    }
-    else {
-        cv::Mat bin3;
-        std::array arr_bin3 { bin, bin, bin };
-        cv::merge(arr_bin3, bin3);
-        ocr_analyzer = OCRer(bin3, bounding_rect);
-    }
-
-    auto config = m_params;
-    config.without_det = true;
-    ocr_analyzer.set_params(std::move(config));
-
-    auto result = ocr_analyzer.analyze();
-    if (!result) {
-        return std::nullopt;
+        return Region { .image = m_image, .roi = new_roi };
     }
-    m_result = result->front();
-    if (!m_use_raw) {
-        m_result.rect.x += m_roi.x;
-        m_result.rect.y += m_roi.y;
-    }
-    return m_result;
+    cv::Mat bin3;
+    std::array arr_bin3 { bin, bin, bin };
+    cv::merge(arr_bin3, bin3);
+    return Region { .image = bin3, .roi = bounding_rect };
 }
 
 void asst::RegionOCRer::bin_left_trim(cv::Mat& bin) const
@@ -15,13 +15,28 @@ namespace asst
 
         ResultOpt analyze() const;
         void set_use_raw(bool use_raw) { m_use_raw = use_raw; }
+
+        // 批量识别 image 上的多个区域，每个区域的预处理与 analyze() 相同，但 OCR 只推理一次
+        // 返回值与 rois 一一对应
+        static std::vector<ResultOpt> analyze_batch(
+            const cv::Mat& image,
+            const std::vector<Rect>& rois,
+            const OCRerConfig::Params& params,
+            bool use_raw = true);
         // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
         const auto& get_result() const noexcept { return m_result; }
 
     protected:
+        struct Region
+        {
+            cv::Mat image; // 送去识别的图像（原图或二值图）
+            Rect roi;      // 识别区域在 image 中的位置
+        };
+
         using OCRerConfig::set_without_det;
         virtual void _set_roi(const Rect& roi) override { set_roi(roi); }
 
+        std::optional<Region> preproc_region() const;
         void bin_left_trim(cv::Mat& bin) const;
         void bin_right_trim(cv::Mat& bin) const;
 
@@ -2,12 +2,16 @@
 
 #include "Config/TaskData.h"
 #include "MultiMatcher.h"
+#include "PerfStats.h"
 #include "RegionOCRer.h"
+#include "Utils/Logger.hpp"
 
 using namespace asst;
 
 TemplDetOCRer::ResultsVecOpt TemplDetOCRer::analyze() const
 {
+    PerfStats::Scope perf_scope(PerfStats::Category::Analyzer, "TemplDetOCRer");
+
     MultiMatcher flag_analyzer(m_image, m_roi);
     flag_analyzer.set_params(MatcherConfig::m_params);
 
@@ -17,17 +21,21 @@ TemplDetOCRer::ResultsVecOpt TemplDetOCRer::analyze() const
     }
     auto& matched_vec = *matched_vec_opt;
 
-    ResultsVec results;
+    std::vector<Rect> ocr_rois;
+    ocr_rois.reserve(matched_vec.size());
     for (const auto& matched : matched_vec) {
-        Rect roi = matched.rect.move(m_flag_rect_move);
+        ocr_rois.emplace_back(matched.rect.move(m_flag_rect_move));
+    }
+    // 所有 flag 对应的文字区域一起送去识别
+    auto ocr_results = RegionOCRer::analyze_batch(m_image, ocr_rois, OCRerConfig::m_params, m_use_raw);
 
-        RegionOCRer ocr_analyzer(m_image, roi);
-        ocr_analyzer.set_params(OCRerConfig::m_params);
-        ocr_analyzer.set_use_raw(m_use_raw);
-        auto ocr_opt = ocr_analyzer.analyze();
+    ResultsVec results;
+    for (size_t i = 0; i < matched_vec.size(); ++i) {
+        const auto& ocr_opt = ocr_results[i];
         if (!ocr_opt) {
             continue;
         }
+        const auto& matched = matched_vec[i];
         Result result;
         result.text = ocr_opt->text;
         result.rect = ocr_opt->rect;
@@ -57,6 +65,31 @@ void TemplDetOCRer::set_task_info(const std::string& templ_task_name, const std:
     OCRerConfig::_set_task_info(*ocr_task_ptr);
 }
 
+void TemplDetOCRer::set_task_info(
+    const std::vector<std::string>& templ_task_names,
+    const std::string& ocr_task_name)
+{
+    if (templ_task_names.empty()) {
+        Log.error(__FUNCTION__, "templ_task_names is empty");
+        return;
+    }
+
+    auto first_task_ptr = Task.get<MatchTaskInfo>(templ_task_names.front());
+    MatchTaskInfo merged = *first_task_ptr;
+    for (size_t i = 1; i < templ_task_names.size(); ++i) {
+        auto match_task_ptr = Task.get<MatchTaskInfo>(templ_task_names[i]);
+        ranges::copy(match_task_ptr->templ_names, std::back_inserter(merged.templ_names));
+        ranges::copy(match_task_ptr->templ_thresholds, std::back_inserter(merged.templ_thresholds));
+        ranges::copy(match_task_ptr->methods, std::back_inserter(merged.methods));
+    }
+    m_roi = merged.roi;
+    MatcherConfig::_set_task_info(std::move(merged));
+
+    auto ocr_task_ptr = Task.get<OcrTaskInfo>(ocr_task_name);
+    m_flag_rect_move = ocr_task_ptr->roi;
+    OCRerConfig::_set_task_info(*ocr_task_ptr);
+}
+
 void TemplDetOCRer::set_flag_rect_move(Rect flag_rect_move)
 {
     m_flag_rect_move = flag_rect_move;
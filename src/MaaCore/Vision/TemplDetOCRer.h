@@ -22,6 +22,8 @@ namespace asst
         virtual ~TemplDetOCRer() override = default;
 
         void set_task_info(const std::string& templ_task_name, const std::string& ocr_task_name);
+        // 多个模板任务合并为一次多模板匹配，mask、roi 等其余参数取第一个模板任务的
+        void set_task_info(const std::vector<std::string>& templ_task_names, const std::string& ocr_task_name);
         void set_flag_rect_move(Rect flag_rect_move);
         void set_ocr_use_raw(bool use_raw) { m_use_raw = use_raw; }
 
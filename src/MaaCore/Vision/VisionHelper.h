@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "Common/AsstTypes.h"
 #include "InstHelper.h"
 #include "Utils/NoWarningCVMat.h"
@@ -111,28 +114,66 @@ namespace asst
     }
 
     // Non-Maximum Suppression
+    // 已保留的框按所覆盖的格子分桶，每个框只和同格子里的已保留框比较，结果与两两比较完全一致
     template <typename ResultsVec>
     inline static ResultsVec NMS(ResultsVec results, double threshold = 0.7)
     {
+        constexpr int CellSize = 128;
+
         ranges::sort(results, [](const auto& a, const auto& b) { return a.score > b.score; });
 
+        auto cell_of = [](int v) { return v >= 0 ? v / CellSize : (v - CellSize + 1) / CellSize; };
+        auto cell_key = [](int cell_x, int cell_y) {
+            return (static_cast<int64_t>(cell_x) << 32) | static_cast<uint32_t>(cell_y);
+        };
+        std::unordered_map<int64_t, std::vector<size_t>> grid; // 格子 -> nms_results 中的下标
+
         ResultsVec nms_results;
-        for (size_t i = 0; i < results.size(); ++i) {
-            const auto& box = results[i];
+        for (const auto& box : results) {
             if (box.score < 0.1f) {
                 continue;
             }
-            nms_results.emplace_back(box);
-            for (size_t j = i + 1; j < results.size(); ++j) {
-                auto& box2 = results[j];
-                if (box2.score < 0.1f) {
-                    continue;
+            const Rect& rect = box.rect;
+            // 宽高非正的框与任何框的交集都为空：面积为负时会被任意已保留的框抑制，否则不会被抑制
+            if (rect.width <= 0 || rect.height <= 0) {
+                if (rect.area() >= 0 || nms_results.empty()) {
+                    nms_results.emplace_back(box);
                 }
-                int iou_area = (make_rect<cv::Rect>(box.rect) & make_rect<cv::Rect>(box2.rect)).area();
-                if (iou_area > threshold * box2.rect.area()) {
-                    box2.score = 0;
+                continue;
+            }
+
+            const int cell_left = cell_of(rect.x);
+            const int cell_right = cell_of(rect.x + rect.width - 1);
+            const int cell_top = cell_of(rect.y);
+            const int cell_bottom = cell_of(rect.y + rect.height - 1);
+
+            bool suppressed = false;
+            for (int cell_x = cell_left; cell_x <= cell_right && !suppressed; ++cell_x) {
+                for (int cell_y = cell_top; cell_y <= cell_bottom && !suppressed; ++cell_y) {
+                    auto iter = grid.find(cell_key(cell_x, cell_y));
+                    if (iter == grid.end()) {
+                        continue;
+                    }
+                    for (size_t kept_index : iter->second) {
+                        const Rect& kept = nms_results[kept_index].rect;
+                        int iou_area = (make_rect<cv::Rect>(kept) & make_rect<cv::Rect>(rect)).area();
+                        if (iou_area > threshold * rect.area()) {
+                            suppressed = true;
+                            break;
+                        }
+                    }
                 }
             }
+            if (suppressed) {
+                continue;
+            }
+
+            for (int cell_x = cell_left; cell_x <= cell_right; ++cell_x) {
+                for (int cell_y = cell_top; cell_y <= cell_bottom; ++cell_y) {
+                    grid[cell_key(cell_x, cell_y)].emplace_back(nms_results.size());
+                }
+            }
+            nms_results.emplace_back(box);
         }
         return nms_results;
     }
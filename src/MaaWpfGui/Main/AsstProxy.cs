@@ -2836,6 +2836,11 @@ namespace MaaWpfGui.Main
         /// 用GPU进行OCR
         /// </summary>
         GpuOCR,
+
+        /// <summary>
+        /// 多实例共享的回调/异步调用线程数，0 为关闭
+        /// </summary>
+        SharedWorkers,
     }
 
     public enum InstanceOptionKey